@@ -26,15 +26,27 @@
 /* swephelp headers */
 #include "swhaspect.h"
 #include "swhatlas.h"
+#include "swhcache.h"
+#include "swhcheby.h"
+#include "swhcontext.h"
 #include "swhdatetime.h"
 #include "swhdb.h"
 #include "swhdef.h"
 #include "swhformat.h"
 #include "swhgeo.h"
+#include "swhingress.h"
+#include "swhlunation.h"
+#include "swhmidpoint.h"
 #include "swhmisc.h"
+#include "swhparallel.h"
+#include "swhprogress.h"
 #include "swhraman.h"
 #include "swhsearch.h"
+#include "swhstar.h"
+#include "swhstations.h"
+#include "swhstats.h"
 #include "swhtimezone.h"
+#include "swhvoc.h"
 
 #ifdef __cplusplus
 #include "swhdbxx.hpp"
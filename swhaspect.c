@@ -20,9 +20,54 @@
 #include <assert.h>
 #include <math.h>
 #include <swephexp.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 #include "swhaspect.h"
 
+/* vectors of doubles, for the aspect grid */
+#if defined(__AVX__)
+#define VLEN            4
+#define vdbl            __m256d
+#define V_SET1(x)       _mm256_set1_pd(x)
+#define V_LOAD(p)       _mm256_loadu_pd(p)
+#define V_STORE(p, v)   _mm256_storeu_pd(p, v)
+#define V_ADD(a, b)     _mm256_add_pd(a, b)
+#define V_SUB(a, b)     _mm256_sub_pd(a, b)
+#define V_DIV(a, b)     _mm256_div_pd(a, b)
+#define V_AND(a, b)     _mm256_and_pd(a, b)
+#define V_OR(a, b)      _mm256_or_pd(a, b)
+#define V_ANDNOT(a, b)  _mm256_andnot_pd(a, b)
+#define V_LT(a, b)      _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define V_LE(a, b)      _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define V_EQ(a, b)      _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+#define V_MASK(m)       _mm256_movemask_pd(m)
+#elif defined(__SSE2__) || defined(_M_X64)
+#define VLEN            2
+#define vdbl            __m128d
+#define V_SET1(x)       _mm_set1_pd(x)
+#define V_LOAD(p)       _mm_loadu_pd(p)
+#define V_STORE(p, v)   _mm_storeu_pd(p, v)
+#define V_ADD(a, b)     _mm_add_pd(a, b)
+#define V_SUB(a, b)     _mm_sub_pd(a, b)
+#define V_DIV(a, b)     _mm_div_pd(a, b)
+#define V_AND(a, b)     _mm_and_pd(a, b)
+#define V_OR(a, b)      _mm_or_pd(a, b)
+#define V_ANDNOT(a, b)  _mm_andnot_pd(a, b)
+#define V_LT(a, b)      _mm_cmplt_pd(a, b)
+#define V_LE(a, b)      _mm_cmple_pd(a, b)
+#define V_EQ(a, b)      _mm_cmpeq_pd(a, b)
+#define V_MASK(m)       _mm_movemask_pd(m)
+#endif
+#ifdef VLEN
+/* a where mask m is set, else b */
+#define V_SEL(m, a, b)  V_OR(V_AND(m, a), V_ANDNOT(m, b))
+#define V_ABS(a)        V_ANDNOT(V_SET1(-0.0), a)
+#endif
+
 int swh_match_aspect(
     double pos0,
     double speed0,
@@ -167,6 +212,164 @@ int swh_match_aspect4(
     return x1;
 }
 
+#ifdef VLEN
+/* swh_match_aspect3 on a vector of distances (swe_difdegn) */
+void _swh_grid_match(
+    vdbl diff,
+    vdbl s0,
+    vdbl s1,
+    double aspect,
+    const double* orbs,
+    vdbl* mret,
+    vdbl* dret,
+    vdbl* sret,
+    vdbl* fret)
+{
+    const vdbl zero = V_SET1(0);
+    const vdbl asp = V_SET1(aspect);
+    const vdbl eq = V_EQ(diff, asp);
+    const vdbl d = V_SUB(diff, asp);
+    const vdbl s = V_SEL(V_LT(zero, d), V_SUB(s1, s0), V_SUB(s0, s1));
+    const vdbl seq = V_SEL(V_LT(s1, s0), V_SUB(s0, s1),
+                           V_SEL(V_LT(s0, s1), V_SUB(s1, s0), zero));
+    const vdbl orb = V_SEL(V_LT(s, zero), V_SET1(orbs[0]),
+                           V_SEL(V_LT(zero, s), V_SET1(orbs[1]),
+                                 V_SET1(orbs[2])));
+    const vdbl m = V_AND(V_LE(V_SUB(asp, orb), diff),
+                         V_LE(diff, V_ADD(asp, orb)));
+    *mret = V_OR(eq, m);
+    *dret = V_SEL(eq, zero, d);
+    *sret = V_SEL(eq, seq, s);
+    *fret = V_SEL(eq, zero, V_DIV(d, orb));
+}
+#endif
+
+int _swh_grid_hit(
+    struct swh_grid_hit* hits,
+    int max,
+    int n,
+    int i,
+    int j,
+    int k,
+    double diff,
+    double speed,
+    double fac)
+{
+    if (n < max) {
+        hits[n].i = i;
+        hits[n].j = j;
+        hits[n].k = k;
+        hits[n].diff = diff;
+        hits[n].speed = speed;
+        hits[n].fac = fac;
+    }
+    return n + 1;
+}
+
+int swh_match_aspect_grid(
+    const double* pos0,
+    const double* speed0,
+    int n0,
+    const double* pos1,
+    const double* speed1,
+    int n1,
+    const struct swh_grid_aspect* aspects,
+    int naspects,
+    int half,
+    int upper,
+    struct swh_grid_hit* hits,
+    int max)
+{
+    int i, j, k, n = 0;
+
+    assert(pos0);
+    assert(pos1);
+    assert(aspects);
+    assert(hits || !max);
+
+    for (i = 0; i < n0; ++i) {
+        const double p0 = pos0[i];
+        const double s0 = speed0 ? speed0[i] : 0;
+        for (k = 0; k < naspects; ++k) {
+            const struct swh_grid_aspect* a = &aspects[k];
+            j = upper ? i + 1 : 0;
+#ifdef VLEN
+            {
+                double asp = a->aspect;
+                const double orbs[3] = {fabs(a->app_orb), fabs(a->sep_orb),
+                                        fabs(a->def_orb)};
+                const vdbl vp0 = V_SET1(p0);
+                const vdbl vs0 = V_SET1(s0);
+                int two;
+                if (half && (asp < 0 || asp > 180))
+                    asp = swe_difdegn(0, asp);
+                two = half && asp != 0 && asp != 180;
+                for (; j + VLEN <= n1; j += VLEN) {
+                    const vdbl vs1 = speed1 ? V_LOAD(&speed1[j]) : V_SET1(0);
+                    vdbl x = V_SUB(V_LOAD(&pos1[j]), vp0);
+                    vdbl m, d, s, f;
+                    double dv[VLEN], sv[VLEN], fv[VLEN];
+                    int l, bits;
+                    /* as swe_difdegn, fmod is exact within ]-360;360[ */
+                    if (V_MASK(V_LE(V_SET1(360), V_ABS(x)))) {
+                        for (l = 0; l < VLEN; ++l) {
+                            const double s1 = speed1 ? speed1[j+l] : 0;
+                            double r[3];
+                            if (!(half ? swh_match_aspect4 :
+                                  swh_match_aspect3)(p0, s0, pos1[j+l], s1,
+                                                     a->aspect, a->app_orb,
+                                                     a->sep_orb, a->def_orb,
+                                                     &r[0], &r[1], &r[2]))
+                                n = _swh_grid_hit(hits, max, n, i, j + l, k,
+                                                  r[0], r[1], r[2]);
+                        }
+                        continue;
+                    }
+                    x = V_SEL(V_LT(V_ABS(x), V_SET1(1e-13)), V_SET1(0), x);
+                    x = V_SEL(V_LT(x, V_SET1(0)), V_ADD(x, V_SET1(360)), x);
+                    _swh_grid_match(x, vs0, vs1, swe_degnorm(asp), orbs,
+                                    &m, &d, &s, &f);
+                    if (two) {
+                        vdbl m1, d1, s1, f1, second;
+                        _swh_grid_match(x, vs0, vs1, swe_degnorm(-(asp)),
+                                        orbs, &m1, &d1, &s1, &f1);
+                        /* as swh_match_aspect4 */
+                        second = V_OR(V_LT(V_ABS(d1), V_ABS(d)),
+                                      V_ANDNOT(V_LT(V_ABS(d), V_ABS(d1)),
+                                               V_LT(s1, s)));
+                        m = V_SEL(second, m1, m);
+                        d = V_SEL(second, d1, d);
+                        s = V_SEL(second, s1, s);
+                        f = V_SEL(second, f1, f);
+                    }
+                    bits = V_MASK(m);
+                    if (!bits)
+                        continue;
+                    V_STORE(dv, d);
+                    V_STORE(sv, s);
+                    V_STORE(fv, f);
+                    for (l = 0; l < VLEN; ++l) {
+                        if (bits & (1 << l))
+                            n = _swh_grid_hit(hits, max, n, i, j + l, k,
+                                              dv[l], sv[l], fv[l]);
+                    }
+                }
+            }
+#endif
+            for (; j < n1; ++j) {
+                const double s1 = speed1 ? speed1[j] : 0;
+                double r[3];
+                if (!(half ? swh_match_aspect4 : swh_match_aspect3)(
+                        p0, s0, pos1[j], s1, a->aspect, a->app_orb,
+                        a->sep_orb, a->def_orb, &r[0], &r[1], &r[2]))
+                    n = _swh_grid_hit(hits, max, n, i, j, k,
+                                      r[0], r[1], r[2]);
+            }
+        }
+    }
+    return n;
+}
+
 void swh_antiscion(
     const double pos[6],
     const double axis,
@@ -116,6 +116,69 @@ int swh_match_aspect4(
     double* speedret,
     double* facret);
 
+/** @brief Aspect of an aspect grid, with its orbs */
+struct swh_grid_aspect
+{
+    double aspect;      /* Aspect targeted, in degrees */
+    double app_orb;     /* Orb when applying, in degrees */
+    double sep_orb;     /* Orb when separating, in degrees */
+    double def_orb;     /* Orb when stable, in degrees */
+};
+
+/** @brief Aspect found in an aspect grid */
+struct swh_grid_hit
+{
+    int i;          /* Index of first object */
+    int j;          /* Index of second object */
+    int k;          /* Index of aspect */
+    double diff;    /* Difference between aspect and objects distance */
+    double speed;   /* Difference speed, in degrees per day */
+    double fac;     /* Difference expressed in orb units */
+};
+
+/** @brief Aspect matching - grid of objects and aspects
+ *
+ * Match every object of a first set with every object of a second set,
+ * for every aspect, as with swh_match_aspect3 (or swh_match_aspect4 if
+ * half is set), and list the aspects matching within orbs. With equal
+ * orbs, this is the same as swh_match_aspect (or swh_match_aspect2).
+ *
+ * Objects are given as arrays of longitudes and speeds. The second set is
+ * processed several objects at a time, with AVX when compiled for it
+ * (-mavx), else SSE2 (x86-64), else one at a time. Results are exactly
+ * those of the scalar functions.
+ *
+ * Aspects are listed by first object, then aspect, then second object.
+ *
+ * @param pos0 First objects longitudes, in degrees [0;360[
+ * @param speed0 First objects longitude speeds, or NULL for zero
+ * @param n0 Number of first objects
+ * @param pos1 Second objects longitudes, in degrees [0;360[
+ * @param speed1 Second objects longitude speeds, or NULL for zero
+ * @param n1 Number of second objects
+ * @param aspects Aspects targeted, with their orbs
+ * @param naspects Number of aspects
+ * @param half Aspects in [0;180] (boolean), else [0;360[
+ * @param upper Only match first object i with second objects after i, when
+ * both sets are the same (boolean)
+ * @param hits Aspects found, declared as struct swh_grid_hit[max]
+ * @param max Size of hits
+ * @return Number of aspects found (may be greater than max)
+ */
+int swh_match_aspect_grid(
+    const double* pos0,
+    const double* speed0,
+    int n0,
+    const double* pos1,
+    const double* speed1,
+    int n1,
+    const struct swh_grid_aspect* aspects,
+    int naspects,
+    int half,
+    int upper,
+    struct swh_grid_hit* hits,
+    int max);
+
 /** @brief Calculate antiscion and contrantiscion
  *
  * @param pos Object positions and speeds, as returned by swe_calc functions
@@ -0,0 +1,237 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Benchmark of the search, aspect and datetime functions.
+ *
+ * Usage: swephelp_bench [SCALE [EPHEPATH]]
+ *
+ * Scenarios are fixed (same dates, same inputs), SCALE multiplies the
+ * number of calls of each one (default 1). One line is printed per
+ * scenario, tab-separated: name, calls, nanoseconds per call, target
+ * function evaluations, and evaluations per second. Evaluations are only
+ * counted if swephelp is compiled with SWH_SEARCH_STATS, else they are
+ * printed as 0.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <swephexp.h>
+
+#include "swephelp.h"
+
+#define JDSTART     (2451545.0) /* 2000-01-01 12:00 UT */
+#define MATCHSIZE   (1 << 16)
+
+typedef struct
+{
+    const char* name;
+    int calls;
+    int (*run)(int arg, int i, char* err);
+    int arg;
+} swh_bench_t;
+
+/* starting date of call i, spread over two centuries */
+double bench_jd(int i)
+{
+    return JDSTART - 36525 + (i * 7919.37);
+}
+
+int bench_aspect(int planet, int i, char* err)
+{
+    double jd, pos[6];
+    const double jdstart = bench_jd(i);
+    if (swe_calc_ut(jdstart, planet, SEFLG_SPEED, pos, err) < 0)
+        return 1;
+    /* target ahead of the planet, reached within a few revolutions */
+    return swh_next_aspect(planet, 0, pos[0] + 10 + (i % 7), jdstart,
+                           i % 2, 0, SEFLG_SPEED, &jd, NULL, err);
+}
+
+int bench_aspect_with2(int pair, int i, char* err)
+{
+    const int planets[2][2] = {{SE_MOON, SE_SUN}, {SE_JUPITER, SE_SATURN}};
+    const double aspects[3] = {0, 60, 90};
+    double jd;
+    return swh_next_aspect_with2(planets[pair][0], aspects[i % 3],
+                                 planets[pair][1], NULL, bench_jd(i), 0, 0,
+                                 SEFLG_SPEED, &jd, NULL, NULL, err);
+}
+
+int bench_retro(int planet, int i, char* err)
+{
+    double jd;
+    return swh_next_retro(planet, bench_jd(i), i % 2, 0, SEFLG_SPEED, &jd,
+                          NULL, err);
+}
+
+int bench_cusp(int hsys, int i, char* err)
+{
+    double jd;
+    return swh_next_aspect_cusp(SE_SUN, NULL, (i % 4) * 90, 1 + (i % 12),
+                                bench_jd(i), 48.85, 2.35, hsys, i % 2,
+                                SEFLG_SPEED, &jd, NULL, NULL, NULL, err);
+}
+
+int bench_years(int years, int i, char* err)
+{
+    double y;
+    const double jd = bench_jd(i);
+    return swh_years_diff(jd, jd + (years * 365.25) + (i % 100), SEFLG_SPEED,
+                          &y, err);
+}
+
+double* bench_lon = NULL;
+double* bench_speed = NULL;
+
+int bench_match(int aspect, int i, char* err)
+{
+    double diff, speed, fac;
+    const int j = i & (MATCHSIZE - 1);
+    const int k = (j + 1) & (MATCHSIZE - 1);
+    swh_match_aspect(bench_lon[j], bench_speed[j], bench_lon[k],
+                     bench_speed[k], aspect, 8, &diff, &speed, &fac);
+    return 0;
+}
+
+int bench_dt2i(int arg, int i, char* err)
+{
+    const char* dt[4] = {"2020-05-17 12:34:56", "-0044/03/15 11:00",
+                         "1969-07-21T02:56:15", "1900 1 1"};
+    int ret[6];
+    if (swh_dt2i(dt[i % 4], ret)) {
+        sprintf(err, "invalid datetime");
+        return 1;
+    }
+    return 0;
+}
+
+int bench_geoc2d(int arg, int i, char* err)
+{
+    const char* coord[4] = {"48:51:24N", "2°21'07\"E", "33S52:07",
+                            "151:12:36.5E"};
+    double ret;
+    if (swh_geoc2d(coord[i % 4], &ret)) {
+        sprintf(err, "invalid coordinate");
+        return 1;
+    }
+    return 0;
+}
+
+/* monotonic clock, in seconds */
+double bench_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER c, f;
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (double) c.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    const swh_bench_t benchs[] = {
+        {"next_aspect_sun", 200, &bench_aspect, SE_SUN},
+        {"next_aspect_moon", 200, &bench_aspect, SE_MOON},
+        {"next_aspect_mercury", 100, &bench_aspect, SE_MERCURY},
+        {"next_aspect_venus", 100, &bench_aspect, SE_VENUS},
+        {"next_aspect_mars", 100, &bench_aspect, SE_MARS},
+        {"next_aspect_jupiter", 50, &bench_aspect, SE_JUPITER},
+        {"next_aspect_saturn", 50, &bench_aspect, SE_SATURN},
+        {"next_aspect_uranus", 20, &bench_aspect, SE_URANUS},
+        {"next_aspect_neptune", 20, &bench_aspect, SE_NEPTUNE},
+        {"next_aspect_pluto", 20, &bench_aspect, SE_PLUTO},
+        {"next_aspect_with2_fast", 200, &bench_aspect_with2, 0},
+        {"next_aspect_with2_slow", 20, &bench_aspect_with2, 1},
+        {"next_retro_mercury", 100, &bench_retro, SE_MERCURY},
+        {"next_retro_mars", 50, &bench_retro, SE_MARS},
+        {"next_retro_saturn", 50, &bench_retro, SE_SATURN},
+        {"next_aspect_cusp_placidus", 200, &bench_cusp, 'P'},
+        {"next_aspect_cusp_equal", 200, &bench_cusp, 'E'},
+        {"years_diff_1", 500, &bench_years, 1},
+        {"years_diff_10", 500, &bench_years, 10},
+        {"years_diff_100", 500, &bench_years, 100},
+        {"match_aspect", 10000000, &bench_match, 90},
+        {"dt2i", 1000000, &bench_dt2i, 0},
+        {"geoc2d", 1000000, &bench_geoc2d, 0}
+    };
+    const int nbenchs = sizeof(benchs) / sizeof(swh_bench_t);
+    struct swh_search_stats st;
+    double scale = 1;
+    char err[256] = {0};
+    int i, j, x = 0;
+
+    if (argc > 3) {
+        fprintf(stderr, "Usage: %s [SCALE [EPHEPATH]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 2 && (scale = atof(argv[1])) <= 0) {
+        fprintf(stderr, "invalid scale: %s\n", argv[1]);
+        return 1;
+    }
+    swe_set_ephe_path(argc == 3 ? argv[2] : NULL);
+    bench_lon = malloc(sizeof(double) * MATCHSIZE);
+    bench_speed = malloc(sizeof(double) * MATCHSIZE);
+    if (!bench_lon || !bench_speed) {
+        fprintf(stderr, "error: nomem\n");
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < MATCHSIZE; ++i) {
+        bench_lon[i] = (rand() % 3600000) / 10000.0;
+        bench_speed[i] = ((rand() % 2000) - 500) / 1000.0;
+    }
+
+    printf("name\tcalls\tns_per_call\tevals\tevals_per_sec\n");
+    for (i = 0; i < nbenchs && !x; ++i) {
+        const int calls = (int) (benchs[i].calls * scale) + 1;
+        double t;
+        swh_search_stats_reset();
+        t = bench_now();
+        for (j = 0; j < calls; ++j) {
+            if ((*benchs[i].run)(benchs[i].arg, j, err)) {
+                fprintf(stderr, "error: %s: %s\n", benchs[i].name, err);
+                x = 1;
+                break;
+            }
+        }
+        t = bench_now() - t;
+        swh_search_stats_get(&st);
+        if (!x)
+            printf("%s\t%d\t%.1f\t%llu\t%.0f\n", benchs[i].name, calls,
+                   (t * 1e9) / calls, st.evals, t > 0 ? st.evals / t : 0);
+    }
+    free(bench_lon);
+    free(bench_speed);
+    swe_close();
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,186 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcheby.h"
+#include "swhstats.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
+
+typedef struct
+{
+    double jd;
+    int planet;
+    int flags;
+    int ret;
+    int used;
+    double res[6];
+} swh_cache_entry_t;
+
+typedef struct
+{
+    double jd;
+    double lat;
+    double lon;
+    int flags;
+    int hsys;
+    int ret;
+    int used;
+    double cusps[37];
+    double ascmc[10];
+} swh_cache_hentry_t;
+
+typedef struct
+{
+    swh_cache_entry_t calc[SWH_CACHE_SIZE];
+    swh_cache_hentry_t houses[SWH_CACHE_HSIZE];
+} swh_cache_t;
+
+static TLS swh_cache_t* _swh_cache = NULL;
+
+static unsigned long long _swh_cache_hashd(double d)
+{
+    unsigned long long h;
+    memcpy(&h, &d, sizeof(h));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+int swh_cache_enable(int enable)
+{
+    if (!enable) {
+        if (_swh_cache) {
+            free(_swh_cache);
+            _swh_cache = NULL;
+        }
+        return 0;
+    }
+    if (_swh_cache)
+        return 0;
+    _swh_cache = calloc(1, sizeof(swh_cache_t));
+    return _swh_cache ? 0 : 1;
+}
+
+int swh_cache_enabled(void)
+{
+    return _swh_cache ? 1 : 0;
+}
+
+void swh_cache_clear(void)
+{
+    if (_swh_cache)
+        memset(_swh_cache, 0, sizeof(swh_cache_t));
+}
+
+int swh_cache_calc_ut(
+    double tjdut,
+    int planet,
+    int flags,
+    double* res,
+    char* err)
+{
+    int x;
+    swh_cache_entry_t* e;
+
+    if (!swh_cheby_get(tjdut, planet, flags, res, &x)) {
+        SWH_STATS_INC(interp);
+        return x;
+    }
+    if (!_swh_cache) {
+        SWH_STATS_INC(calc);
+        return swe_calc_ut(tjdut, planet, flags, res, err);
+    }
+    e = &_swh_cache->calc[(_swh_cache_hashd(tjdut)
+        ^ ((unsigned long long) planet * 31)
+        ^ ((unsigned long long) flags * 131)) & (SWH_CACHE_SIZE - 1)];
+    if (e->used && e->jd == tjdut && e->planet == planet
+        && e->flags == flags) {
+        memcpy(res, e->res, sizeof(double) * 6);
+        SWH_STATS_INC(cached);
+        return e->ret;
+    }
+    SWH_STATS_INC(calc);
+    x = swe_calc_ut(tjdut, planet, flags, res, err);
+    if (x < 0)
+        return x;
+    e->jd = tjdut;
+    e->planet = planet;
+    e->flags = flags;
+    e->ret = x;
+    e->used = 1;
+    memcpy(e->res, res, sizeof(double) * 6);
+    return x;
+}
+
+int swh_cache_houses_ex(
+    double tjdut,
+    int flags,
+    double lat,
+    double lon,
+    int hsys,
+    double* cusps,
+    double* ascmc)
+{
+    int x;
+    const int n = (hsys == 'G' ? 37 : 13);
+    swh_cache_hentry_t* e;
+
+    if (!_swh_cache) {
+        SWH_STATS_INC(houses);
+        return swe_houses_ex(tjdut, flags, lat, lon, hsys, cusps, ascmc);
+    }
+    e = &_swh_cache->houses[(_swh_cache_hashd(tjdut)
+        ^ _swh_cache_hashd(lat) ^ (_swh_cache_hashd(lon) >> 7)
+        ^ ((unsigned long long) hsys * 31)
+        ^ ((unsigned long long) flags * 131)) & (SWH_CACHE_HSIZE - 1)];
+    if (e->used && e->jd == tjdut && e->lat == lat && e->lon == lon
+        && e->hsys == hsys && e->flags == flags) {
+        memcpy(cusps, e->cusps, sizeof(double) * n);
+        memcpy(ascmc, e->ascmc, sizeof(double) * 10);
+        SWH_STATS_INC(cached);
+        return e->ret;
+    }
+    SWH_STATS_INC(houses);
+    x = swe_houses_ex(tjdut, flags, lat, lon, hsys, cusps, ascmc);
+    if (x < 0)
+        return x;
+    e->jd = tjdut;
+    e->lat = lat;
+    e->lon = lon;
+    e->flags = flags;
+    e->hsys = hsys;
+    e->ret = x;
+    e->used = 1;
+    memcpy(e->cusps, cusps, sizeof(double) * n);
+    memcpy(e->ascmc, ascmc, sizeof(double) * 10);
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
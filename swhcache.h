@@ -0,0 +1,100 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHCACHE_H
+#define SWHCACHE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Number of entries in the positions cache (power of 2) */
+#ifndef SWH_CACHE_SIZE
+#define SWH_CACHE_SIZE      4096
+#endif
+
+/** @brief Number of entries in the houses cache (power of 2) */
+#ifndef SWH_CACHE_HSIZE
+#define SWH_CACHE_HSIZE     256
+#endif
+
+/** @brief Enable or disable the ephemeris cache
+ *
+ * When enabled, the positions calculated by the search functions are
+ * memoized, keyed by Julian day, object and flags (and geographic position
+ * and house system for houses). Repeated evaluations of the same instant,
+ * as done by the *2 search variants, are then served from memory.
+ *
+ * @remarks The cache is per thread. Disabling it frees its memory, which
+ * should be done before a thread using the cache terminates.
+ *
+ * @remarks The cache is not aware of swe_set_sid_mode, swe_set_topo, or
+ * swe_set_ephe_path. Call swh_cache_clear after changing those settings.
+ *
+ * @param enable Enable [1], or disable [0] (boolean)
+ * @return 0 on success, or 1 on error (no memory)
+ */
+int swh_cache_enable(int enable);
+
+/** @brief Check if the ephemeris cache is enabled for the current thread
+ * @return 1 if enabled, else 0
+ */
+int swh_cache_enabled(void);
+
+/** @brief Forget all positions memoized by the current thread */
+void swh_cache_clear(void);
+
+/** @brief Calculate positions of a planet, through the cache
+ *
+ * Same as swe_calc_ut. If the cache is disabled, it simply calls swe_calc_ut.
+ * If interpolation is enabled, positions are interpolated when possible.
+ *
+ * @see swh_cheby_enable()
+ * @see swe_calc_ut()
+ */
+int swh_cache_calc_ut(
+    double tjdut,
+    int planet,
+    int flags,
+    double* res,
+    char* err);
+
+/** @brief Calculate houses cusps, through the cache
+ *
+ * Same as swe_houses_ex. If the cache is disabled, it simply calls
+ * swe_houses_ex.
+ *
+ * @see swe_houses_ex()
+ */
+int swh_cache_houses_ex(
+    double tjdut,
+    int flags,
+    double lat,
+    double lon,
+    int hsys,
+    double* cusps,
+    double* ascmc);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHCACHE_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
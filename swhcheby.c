@@ -0,0 +1,280 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhcheby.h"
+#include "swhstats.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
+
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
+
+#define NCOEF   (SWH_CHEBY_DEGREE + 1)
+
+typedef struct
+{
+    long long seg;
+    int planet;
+    int flags;
+    int iflag;
+    int used;
+    int valid;
+    double coef[3][NCOEF]; /* longitude, latitude, distance */
+    double dcoef[3][NCOEF]; /* derivatives, per day */
+} swh_cheby_seg_t;
+
+typedef struct
+{
+    swh_cheby_seg_t segs[SWH_CHEBY_SIZE];
+} swh_cheby_t;
+
+static TLS swh_cheby_t* _swh_cheby = NULL;
+static TLS double _swh_cheby_maxerr = 0;
+static TLS int _swh_cheby_verify = 0;
+static TLS double _swh_cheby_verr = 0;
+static TLS int _swh_cheby_bypass = 0;
+
+int swh_cheby_enable(int enable)
+{
+    if (!enable) {
+        if (_swh_cheby) {
+            free(_swh_cheby);
+            _swh_cheby = NULL;
+        }
+        return 0;
+    }
+    if (_swh_cheby)
+        return 0;
+    _swh_cheby = calloc(1, sizeof(swh_cheby_t));
+    return _swh_cheby ? 0 : 1;
+}
+
+int swh_cheby_enabled(void)
+{
+    return _swh_cheby ? 1 : 0;
+}
+
+void swh_cheby_clear(void)
+{
+    if (_swh_cheby)
+        memset(_swh_cheby, 0, sizeof(swh_cheby_t));
+}
+
+void swh_cheby_set_maxerr(double maxerr)
+{
+    _swh_cheby_maxerr = maxerr > 0 ? maxerr : 0;
+    swh_cheby_clear();
+}
+
+double swh_cheby_get_maxerr(void)
+{
+    return _swh_cheby_maxerr ? _swh_cheby_maxerr : SWH_CHEBY_MAXERR;
+}
+
+void swh_cheby_set_verify(int verify)
+{
+    _swh_cheby_verify = verify ? 1 : 0;
+}
+
+double swh_cheby_verify_maxerr(void)
+{
+    const double e = _swh_cheby_verr;
+    _swh_cheby_verr = 0;
+    return e;
+}
+
+int swh_cheby_bypass(int bypass)
+{
+    const int b = _swh_cheby_bypass;
+    _swh_cheby_bypass = bypass ? 1 : 0;
+    return b;
+}
+
+/* length of segments, in days */
+double _swh_cheby_seglen(int planet, int flags)
+{
+    double len;
+    switch (planet) {
+    case SE_MOON:
+    case SE_TRUE_NODE:
+        len = 4;
+        break;
+    case SE_OSCU_APOG:
+        len = 2;
+        break;
+    case SE_SUN:
+    case SE_EARTH:
+    case SE_VENUS:
+    case SE_MARS:
+        len = 16;
+        break;
+    case SE_MEAN_NODE:
+    case SE_MEAN_APOG:
+    case SE_JUPITER:
+    case SE_SATURN:
+    case SE_URANUS:
+    case SE_NEPTUNE:
+    case SE_PLUTO:
+        len = 32;
+        break;
+    default:
+        len = 8;
+    }
+    /* diurnal parallax */
+    return flags & SEFLG_TOPOCTR ? len / 8 : len;
+}
+
+double _swh_cheby_eval(const double* c, double x)
+{
+    double d = 0, dd = 0, sv;
+    int j;
+    for (j = NCOEF - 1; j > 0; --j) {
+        sv = d;
+        d = (2 * x * d) - dd + c[j];
+        dd = sv;
+    }
+    return (x * d) - dd + (c[0] / 2);
+}
+
+void _swh_cheby_fit(swh_cheby_seg_t* e, double len)
+{
+    double v[3][NCOEF];
+    double res[6];
+    char err[256];
+    const double h = len / 2;
+    const double mid = (e->seg * len) + h;
+    const double maxerr = swh_cheby_get_maxerr();
+    int i, j, k, x = 0;
+
+    e->valid = 0;
+    for (k = 0; k < NCOEF; ++k) {
+        const double t = mid + (h * cos(M_PI * (k + 0.5) / NCOEF));
+        SWH_STATS_INC(calc);
+        x = swe_calc_ut(t, e->planet, e->flags, res, err);
+        if (x < 0)
+            return;
+        /* nodes are in reverse time order, unwrap longitude */
+        if (k)
+            res[0] = v[0][k-1] + swe_difdeg2n(res[0], v[0][k-1]);
+        for (i = 0; i < 3; ++i)
+            v[i][k] = res[i];
+    }
+    e->iflag = x;
+    for (i = 0; i < 3; ++i) {
+        for (j = 0; j < NCOEF; ++j) {
+            double s = 0;
+            for (k = 0; k < NCOEF; ++k)
+                s += v[i][k] * cos(M_PI * j * (k + 0.5) / NCOEF);
+            e->coef[i][j] = (2.0 / NCOEF) * s;
+        }
+        e->dcoef[i][NCOEF-1] = 0;
+        e->dcoef[i][NCOEF-2] = 2 * (NCOEF - 1) * e->coef[i][NCOEF-1];
+        for (j = NCOEF - 2; j > 0; --j)
+            e->dcoef[i][j-1] = e->dcoef[i][j+1] + (2 * j * e->coef[i][j]);
+        for (j = 0; j < NCOEF; ++j)
+            e->dcoef[i][j] /= h;
+    }
+    /* error estimate, from the last terms */
+    for (i = 0; i < 3; ++i) {
+        double tail = fabs(e->coef[i][NCOEF-1]) + fabs(e->coef[i][NCOEF-2]);
+        if (i == 2) /* distance, relative */
+            tail = e->coef[2][0] ?
+                (tail * 2 / fabs(e->coef[2][0])) * (180 / M_PI) : HUGE_VAL;
+        if (tail > maxerr)
+            return;
+    }
+    e->valid = 1;
+}
+
+int swh_cheby_get(
+    double tjdut,
+    int planet,
+    int flags,
+    double* res,
+    int* iflag)
+{
+    const int fflags = flags & ~SEFLG_SPEED;
+    double len, x;
+    unsigned long long h;
+    long long seg;
+    swh_cheby_seg_t* e;
+    int i;
+
+    assert(res);
+    assert(iflag);
+
+    if (!_swh_cheby || _swh_cheby_bypass
+        || (flags & (SEFLG_XYZ|SEFLG_RADIANS)))
+        return 1;
+    len = _swh_cheby_seglen(planet, flags);
+    seg = (long long) floor(tjdut / len);
+    h = (unsigned long long) seg;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    e = &_swh_cheby->segs[(h ^ ((unsigned long long) planet * 31)
+        ^ ((unsigned long long) fflags * 131)) & (SWH_CHEBY_SIZE - 1)];
+    if (!e->used || e->seg != seg || e->planet != planet
+        || e->flags != fflags) {
+        e->seg = seg;
+        e->planet = planet;
+        e->flags = fflags;
+        e->used = 1;
+        _swh_cheby_fit(e, len);
+    }
+    if (!e->valid)
+        return 1;
+    x = ((tjdut - (seg * len)) / (len / 2)) - 1;
+    res[0] = swe_degnorm(_swh_cheby_eval(e->coef[0], x));
+    res[1] = _swh_cheby_eval(e->coef[1], x);
+    res[2] = _swh_cheby_eval(e->coef[2], x);
+    for (i = 3; i < 6; ++i)
+        res[i] = flags & SEFLG_SPEED ? _swh_cheby_eval(e->dcoef[i-3], x) : 0;
+    *iflag = e->iflag | (flags & SEFLG_SPEED);
+    if (_swh_cheby_verify) {
+        double exact[6];
+        char err[256];
+        int ret;
+        SWH_STATS_INC(calc);
+        ret = swe_calc_ut(tjdut, planet, flags, exact, err);
+        if (ret >= 0) {
+            double d = fabs(swe_difdeg2n(res[0], exact[0]));
+            if (fabs(res[1] - exact[1]) > d)
+                d = fabs(res[1] - exact[1]);
+            if (d > _swh_cheby_verr)
+                _swh_cheby_verr = d;
+            memcpy(res, exact, sizeof(double) * 6);
+            *iflag = ret;
+        }
+    }
+    return 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
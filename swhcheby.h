@@ -0,0 +1,134 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHCHEBY_H
+#define SWHCHEBY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Degree of the Chebyshev polynomials */
+#ifndef SWH_CHEBY_DEGREE
+#define SWH_CHEBY_DEGREE    12
+#endif
+
+/** @brief Number of segments kept in memory (power of 2) */
+#ifndef SWH_CHEBY_SIZE
+#define SWH_CHEBY_SIZE      256
+#endif
+
+/** @brief Default maximum interpolation error, in degrees */
+#ifndef SWH_CHEBY_MAXERR
+#define SWH_CHEBY_MAXERR    (1e-6)
+#endif
+
+/** @brief Enable or disable interpolation of positions
+ *
+ * When enabled, the positions requested by the search functions (through
+ * the ephemeris cache functions) are interpolated with Chebyshev
+ * polynomials, fitted on fixed-size segments of time for each object and
+ * flags, on first use. Longitude, latitude and distance are fitted, speeds
+ * are taken from the derivatives of the polynomials.
+ *
+ * Segments whose estimated error exceeds the maximum error (or where
+ * calculation fails) are not used, and positions there are calculated
+ * normally. Roots found by the search functions are polished with exact
+ * positions.
+ *
+ * @remarks Interpolation is per thread. Disabling it frees its memory,
+ * which should be done before a thread using it terminates.
+ *
+ * @remarks Cartesian coordinates and radians (SEFLG_XYZ, SEFLG_RADIANS)
+ * are not interpolated. As with the cache, call swh_cheby_clear after
+ * changing swisseph settings.
+ *
+ * @param enable Enable [1], or disable [0] (boolean)
+ * @return 0 on success, or 1 on error (no memory)
+ */
+int swh_cheby_enable(int enable);
+
+/** @brief Check if interpolation is enabled for the current thread
+ * @return 1 if enabled, else 0
+ */
+int swh_cheby_enabled(void);
+
+/** @brief Forget all segments fitted by the current thread */
+void swh_cheby_clear(void);
+
+/** @brief Set maximum interpolation error, for the current thread
+ *
+ * Segments already fitted are forgotten.
+ *
+ * @param maxerr Maximum error, in degrees, or 0 for default
+ */
+void swh_cheby_set_maxerr(double maxerr);
+
+/** @brief Get maximum interpolation error, for the current thread
+ * @return Maximum error, in degrees
+ */
+double swh_cheby_get_maxerr(void);
+
+/** @brief Check interpolated positions against full calculation
+ *
+ * In verify mode, each interpolated position is also calculated with
+ * swe_calc_ut. The exact position is returned, and the greatest error
+ * found (in longitude or latitude) is recorded.
+ *
+ * @param verify Enable [1], or disable [0] verify mode (boolean)
+ */
+void swh_cheby_set_verify(int verify);
+
+/** @brief Get greatest error found in verify mode, and reset it
+ * @return Greatest error found, in degrees
+ */
+double swh_cheby_verify_maxerr(void);
+
+/** @brief Temporarily bypass interpolation
+ *
+ * Used to get exact positions while interpolation is enabled.
+ *
+ * @param bypass Bypass [1], or restore [0] interpolation (boolean)
+ * @return Previous bypass value
+ */
+int swh_cheby_bypass(int bypass);
+
+/** @brief Get interpolated positions of a planet
+ *
+ * @param tjdut Julian day number, UT
+ * @param planet Planet number (SE_*, etc)
+ * @param flags Calculation flags, see swisseph docs
+ * @param res Positions, declared as double[6]
+ * @param iflag Flags returned by swe_calc_ut when fitting
+ * @return 0 if interpolated, 1 if position must be calculated normally
+ */
+int swh_cheby_get(
+    double tjdut,
+    int planet,
+    int flags,
+    double* res,
+    int* iflag);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHCHEBY_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,119 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "swhcontext.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
+
+/* steps between checks of the clock and calls to progress */
+#define CHECKEVERY  (64)
+
+/* count of steps, shared by worker threads */
+#ifdef _MSC_VER
+#define STEPS_INC(p)    ((unsigned long long) \
+    InterlockedIncrement64((volatile LONG64*)(p)))
+#else
+#define STEPS_INC(p)    __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#endif
+
+static TLS struct swh_search_ctx* _swh_ctx = NULL;
+
+/* monotonic clock, in seconds */
+double _swh_search_ctx_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER c, f;
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (double) c.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+#endif
+}
+
+void swh_search_ctx_set(struct swh_search_ctx* ctx)
+{
+    _swh_ctx = ctx;
+    if (!ctx)
+        return;
+    ctx->steps = 0;
+    ctx->interrupted = 0;
+    ctx->deadline = ctx->timeout > 0 ?
+        _swh_search_ctx_now() + ctx->timeout : 0;
+}
+
+void _swh_search_ctx_share(struct swh_search_ctx* ctx)
+{
+    _swh_ctx = ctx;
+}
+
+struct swh_search_ctx* swh_search_ctx_get(void)
+{
+    return _swh_ctx;
+}
+
+int _swh_search_ctx_check(double jd, char* err)
+{
+    struct swh_search_ctx* ctx = _swh_ctx;
+    unsigned long long steps;
+
+    if (!ctx)
+        return 0;
+    if (!ctx->interrupted) {
+        steps = STEPS_INC(&ctx->steps);
+        if (ctx->cancel)
+            ctx->interrupted = SWH_SEARCH_CANCELLED;
+        else if (ctx->maxsteps && steps > ctx->maxsteps)
+            ctx->interrupted = SWH_SEARCH_MAXSTEPS;
+        else if (steps % CHECKEVERY)
+            return 0;
+        else if (ctx->deadline && _swh_search_ctx_now() > ctx->deadline)
+            ctx->interrupted = SWH_SEARCH_TIMEOUT;
+        else if (ctx->progress && (*ctx->progress)(ctx->arg, jd))
+            ctx->interrupted = SWH_SEARCH_CANCELLED;
+        else
+            return 0;
+    }
+    switch (ctx->interrupted) {
+    case SWH_SEARCH_TIMEOUT:
+        sprintf(err, "search timed out");
+        break;
+    case SWH_SEARCH_MAXSTEPS:
+        sprintf(err, "search steps exhausted");
+        break;
+    default:
+        sprintf(err, "search cancelled");
+    }
+    return 1;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
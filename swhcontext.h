@@ -0,0 +1,90 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHCONTEXT_H
+#define SWHCONTEXT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Reasons for searches to be interrupted */
+#define SWH_SEARCH_CANCELLED    1 /* cancel flag set, or by progress */
+#define SWH_SEARCH_TIMEOUT      2 /* wall time allowed is over */
+#define SWH_SEARCH_MAXSTEPS     3 /* steps allowed are exhausted */
+
+/** @brief Limits of the search functions
+ *
+ * A context bounds the searches (and scans) of the thread it is set for,
+ * with a wall-clock deadline, a maximum number of steps, and a cancel flag
+ * that can be set from another thread. The search loops check it at each
+ * step (one or a few evaluations of the target function), and searches
+ * interrupted fail (return 1) with an error message. The progress callback
+ * is called every few steps with the Julian day reached, and may cancel
+ * searches by returning non-zero.
+ *
+ * Once interrupted, all searches of the thread fail, until another
+ * context is set: set a new one for each job (request).
+ *
+ * The worker threads of swh_aspect_scan_mt share the context of the
+ * calling thread: deadline, steps and cancel flag apply to the whole scan,
+ * and an interruption stops all workers. The progress callback is then
+ * called from the workers, concurrently, with the Julian day reached in
+ * their chunk.
+ */
+struct swh_search_ctx
+{
+    double timeout;                 /* Wall time allowed, in seconds, or 0 */
+    unsigned long long maxsteps;    /* Steps allowed, or 0 */
+    volatile int cancel;            /* Cancel searches (boolean) */
+    int (*progress)(void* arg, double jd); /* Progress callback, or NULL */
+    void* arg;                      /* Argument passed to progress */
+    /* maintained by the search functions */
+    double deadline;                /* Wall-clock deadline, or 0 */
+    volatile unsigned long long steps;  /* Steps done */
+    volatile int interrupted;       /* Reason of interruption, or 0 */
+};
+
+/** @brief Set the search context of the current thread
+ *
+ * The wall clock starts, and the count of steps is reset. The context
+ * must stay valid until it is unset.
+ *
+ * @param ctx Search context, or NULL to unset it
+ */
+void swh_search_ctx_set(struct swh_search_ctx* ctx);
+
+/** @brief Get the search context of the current thread
+ * @return Search context, or NULL if none
+ */
+struct swh_search_ctx* swh_search_ctx_get(void);
+
+/* set the context of a worker thread, shared with the calling thread */
+void _swh_search_ctx_share(struct swh_search_ctx* ctx);
+
+/* check the context at a step of a search, return 1 if interrupted */
+int _swh_search_ctx_check(double jd, char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHCONTEXT_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,188 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcontext.h"
+#include "swhingress.h"
+#include "swhsearch.h"
+#include "swhstats.h"
+
+/* default step, in days */
+#define STEP    (0.5)
+
+/* longer steps must not hold two stations, in days */
+double _swh_ingress_step(int planet, int flags)
+{
+    if (flags & (SEFLG_TOPOCTR|SEFLG_HELCTR|SEFLG_BARYCTR))
+        return STEP;
+    switch (planet) {
+    case SE_SUN: return 2;
+    case SE_MERCURY: return 4;
+    case SE_VENUS:
+    case SE_MARS:
+    case SE_CERES:
+    case SE_PALLAS:
+    case SE_JUNO:
+    case SE_VESTA: return 8;
+    case SE_JUPITER:
+    case SE_SATURN:
+    case SE_URANUS:
+    case SE_NEPTUNE:
+    case SE_PLUTO:
+    case SE_CHIRON:
+    case SE_PHOLUS: return 16;
+    default: return STEP;
+    }
+}
+
+typedef struct
+{
+    int planet;
+    int flags;
+    double lon;     /* boundary */
+    double width;
+    int n;          /* number of divisions */
+    int (*callback)(void* arg, const struct swh_ingress* ing);
+    void* arg;
+} swh_ingress_args_t;
+
+/* distance to boundary */
+int _swh_ingress(double t, void* fargs, double* ret, char* err)
+{
+    const swh_ingress_args_t* args = fargs;
+    double res[6] = {0,0,0,0,0,0};
+
+    int x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
+    if (x < 0)
+        return x;
+    ret[0] = swe_difdeg2n(res[0], args->lon);
+    ret[1] = res[3];
+    return 0;
+}
+
+/* longitude and speed of the planet */
+int _swh_ingress_pos(void* fargs, int i, double t, double* ret, char* err)
+{
+    const swh_ingress_args_t* args = fargs;
+    double res[6] = {0,0,0,0,0,0};
+
+    (void) i;
+    if (swh_cache_calc_ut(t, args->planet, args->flags, res, err) < 0)
+        return 1;
+    ret[0] = res[0];
+    ret[1] = res[3];
+    return 0;
+}
+
+/* report boundaries crossed on a monotonic part of the path */
+int _swh_ingress_segment(
+    void* fargs,
+    int i,
+    double t1,
+    const double* p1,
+    double t2,
+    const double* p2,
+    char* err)
+{
+    swh_ingress_args_t* args = fargs;
+    const double width = args->width;
+    const int n = args->n;
+    const double a = p1[0];
+    const double b = a + swe_difdeg2n(p2[0], a);
+    const int d1 = (int) floor(a / width);
+    const int d2 = (int) floor(b / width);
+    const int up = d2 > d1;
+    struct swh_ingress ing;
+    int k;
+
+    (void) i;
+    ing.planet = args->planet;
+    ing.retro = !up;
+    for (k = up ? d1 + 1 : d1; up ? k <= d2 : k > d2; k += up ? 1 : -1) {
+        double f1[2], f2[2];
+        args->lon = swe_degnorm(k * width);
+        f1[0] = swe_difdeg2n(p1[0], args->lon);
+        f1[1] = p1[1];
+        f2[0] = swe_difdeg2n(p2[0], args->lon);
+        f2[1] = p2[1];
+        if (f1[0] == 0)
+            ing.jd = t1;
+        else if (f2[0] == 0)
+            ing.jd = t2;
+        else if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_ingress, args,
+                                      &ing.jd, err))
+            return 1;
+        ing.index = (((up ? k : k - 1) % n) + n) % n;
+        ing.previous = (((up ? k - 1 : k) % n) + n) % n;
+        if (args->callback(args->arg, &ing))
+            return 2;
+    }
+    return 0;
+}
+
+int swh_ingress_scan(
+    const int* planets,
+    int nplanets,
+    double width,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_ingress* ing),
+    void* arg,
+    char* err)
+{
+    const int n = width > 0 ? (int) floor((360 / width) + 0.5) : 0;
+    swh_ingress_args_t args = {0, 0, 0, 0, 0, NULL, NULL};
+    int i, x = 0;
+
+    assert(planets);
+    assert(callback);
+    assert(err);
+
+    if (n < 1 || fabs((n * width) - 360) > 1e-9) {
+        sprintf(err, "invalid argument");
+        return 3;
+    }
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    args.flags = flags | SEFLG_SPEED;
+    args.width = 360.0 / n;
+    args.n = n;
+    args.callback = callback;
+    args.arg = arg;
+    for (i = 0; i < nplanets && !x; ++i) {
+        args.planet = planets[i];
+        x = _swh_path_walk(1, jdstart, jdend,
+                           _swh_ingress_step(planets[i], flags),
+                           &_swh_ingress_pos, &_swh_ingress_segment, NULL,
+                           &args, err);
+    }
+    SWH_STATS_LEAVE();
+    return x == 1 ? 1 : 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,89 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHINGRESS_H
+#define SWHINGRESS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Widths of usual divisions of the zodiac, in degrees */
+#define SWH_INGRESS_SIGNS       (30.0)      /* signs, rasis */
+#define SWH_INGRESS_DECANS      (10.0)      /* decans, drekkanas */
+#define SWH_INGRESS_NAKSHATRAS  (40/3.0)    /* nakshatras, 13°20' */
+#define SWH_INGRESS_PADAS       (10/3.0)    /* padas, navamsas, 3°20' */
+
+struct swh_ingress
+{
+    int planet;     /* Planet number */
+    int index;      /* Division entered, from 0 at 0 degree */
+    int previous;   /* Division left */
+    int retro;      /* Entered while retrograde (boolean) */
+    double jd;      /* Julian day number of ingress */
+};
+
+/** @brief Scan ingresses of planets in divisions of the zodiac
+ *
+ * The zodiac is divided in equal parts of given width, starting at 0
+ * degree, and every crossing of a boundary by the planets within the time
+ * range is reported, including those due to retrograde motion. Divisions
+ * are numbered as with swh_long2rasi and swh_long2nakshatra (index of
+ * nakshatra times 4 plus pada, for padas). Sidereal divisions need the
+ * SEFLG_SIDEREAL flag.
+ *
+ * Each planet is followed along one path through the range: boundaries
+ * crossed between two steps are refined from the same positions, and
+ * steps are split at stations. Positions go through the ephemeris cache
+ * and interpolation, when enabled.
+ *
+ * The callback is called for each ingress, planet after planet (in given
+ * order), and in chronological order for each planet. If it returns
+ * non-zero, the scan stops.
+ *
+ * @param planets Planet numbers
+ * @param nplanets Number of planets
+ * @param width Width of divisions, in degrees (SWH_INGRESS_*), 360 must
+ * be a multiple of it
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with arg and each ingress
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 3 if width is invalid
+ */
+int swh_ingress_scan(
+    const int* planets,
+    int nplanets,
+    double width,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_ingress* ing),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHINGRESS_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,185 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcontext.h"
+#include "swhlunation.h"
+#include "swhsearch.h"
+#include "swhstats.h"
+
+/* bound below the speed of the Moon relative to the Sun, in degrees/day */
+#define VMIN        (10.0)
+/* steps go beyond the root by that factor */
+#define OVERSHOOT   (1.25)
+/* bound of the distance of true lunations to mean ones, in days */
+#define MAXDEV      (1.5)
+#define MAXITER     (16)
+
+typedef struct
+{
+    double elong;
+    int flags;
+} swh_lunation_args_t;
+
+/* elongation of the Moon to target, with its derivative */
+int _swh_lunation(double t, void* fargs, double* ret, char* err)
+{
+    const swh_lunation_args_t* args = fargs;
+    double moon[6] = {0,0,0,0,0,0};
+    double sun[6] = {0,0,0,0,0,0};
+
+    int x = swh_cache_calc_ut(t, SE_MOON, args->flags, moon, err);
+    if (x < 0)
+        return x;
+    x = swh_cache_calc_ut(t, SE_SUN, args->flags, sun, err);
+    if (x < 0)
+        return x;
+    ret[0] = swe_difdeg2n(moon[0] - sun[0], args->elong);
+    ret[1] = moon[3] - sun[3];
+    return 0;
+}
+
+/* lunations elapsed since epoch at jd (UT) */
+double _swh_lunation_count(double jd)
+{
+    return (jd + swe_deltat(jd) - SWH_LUNATION_EPOCH) / SWH_SYNODIC_MONTH;
+}
+
+/* find a lunation from the mean one, lunations counted from epoch */
+int _swh_lunation_find(double lun, int flags, double* jdret, char* err)
+{
+    const double jde = SWH_LUNATION_EPOCH + (lun * SWH_SYNODIC_MONTH);
+    swh_lunation_args_t args;
+    double t1, t2, f1[2] = {0, HUGE_VAL}, f2[2] = {0, HUGE_VAL};
+    int i;
+
+    args.elong = swe_degnorm(lun * 360);
+    args.flags = flags | SEFLG_SPEED;
+    t2 = jde - swe_deltat(jde);
+    if (_swh_search_ctx_check(t2, err))
+        return 1;
+    SWH_STATS_INC(evals);
+    if (_swh_lunation(t2, &args, f2, err))
+        return 1;
+    /* the Moon is always faster, step beyond the root until bracketed */
+    for (i = 0; i < MAXITER; ++i) {
+        if (f2[0] == 0) {
+            *jdret = t2;
+            return 0;
+        }
+        t1 = t2;
+        f1[0] = f2[0];
+        f1[1] = f2[1];
+        t2 = t1 - ((f1[0] / (f1[1] > VMIN ? f1[1] : VMIN)) * OVERSHOOT);
+        f2[1] = HUGE_VAL;
+        SWH_STATS_INC(evals);
+        if (_swh_lunation(t2, &args, f2, err))
+            return 1;
+        if ((f1[0] < 0) != (f2[0] < 0))
+            return swh_secsearch_refine(t2, f2, t1, f1, &_swh_lunation,
+                                        &args, jdret, err);
+    }
+    sprintf(err, "unable to bracket lunation");
+    return 1;
+}
+
+int swh_next_lunation(
+    double elong,
+    double jdstart,
+    int backw,
+    int flags,
+    double* jdret,
+    char* err)
+{
+    const double e = swe_degnorm(elong) / 360;
+    const double c = _swh_lunation_count(jdstart) - e;
+    double lun;
+    int x = 0;
+
+    assert(jdret);
+    assert(err);
+
+    SWH_STATS_ENTER();
+    /* first mean lunation that can be the true one */
+    lun = backw ? floor(c + (MAXDEV / SWH_SYNODIC_MONTH))
+        : ceil(c - (MAXDEV / SWH_SYNODIC_MONTH));
+    lun += e;
+    for (;;) {
+        x = _swh_lunation_find(lun, flags, jdret, err);
+        if (x || (backw ? *jdret < jdstart : *jdret > jdstart))
+            break;
+        lun += backw ? -1 : 1;
+    }
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+int swh_lunation_scan(
+    double width,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_lunation* lun),
+    void* arg,
+    char* err)
+{
+    const int n = width > 0 ? (int) floor((360 / width) + 0.5) : 0;
+    struct swh_lunation cur;
+    double k;
+    int x = 0;
+
+    assert(callback);
+    assert(err);
+
+    if (n < 1 || fabs((n * width) - 360) > 1e-9) {
+        sprintf(err, "invalid argument");
+        return 3;
+    }
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    /* true events are in the same order as mean ones */
+    k = floor((_swh_lunation_count(jdstart)
+               - (MAXDEV / SWH_SYNODIC_MONTH)) * n);
+    for (;; k += 1) {
+        if (_swh_lunation_find(k / n, flags, &cur.jd, err)) {
+            x = 1;
+            break;
+        }
+        if (cur.jd < jdstart)
+            continue;
+        if (cur.jd >= jdend)
+            break;
+        cur.lunation = (int) floor(k / n);
+        cur.index = (int) (k - (cur.lunation * (double) n));
+        if (callback(arg, &cur))
+            break;
+    }
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,106 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHLUNATION_H
+#define SWHLUNATION_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Mean synodic month, in days */
+#define SWH_SYNODIC_MONTH   (29.530588861)
+
+/** @brief Mean new moon of 2000 January 6, Julian day number (TT) */
+#define SWH_LUNATION_EPOCH  (2451550.09766)
+
+/* Widths of usual divisions of the lunar month, in degrees of elongation */
+#define SWH_LUNATION_NEWMOONS   (360.0) /* new moons */
+#define SWH_LUNATION_SYZYGIES   (180.0) /* new and full moons */
+#define SWH_LUNATION_PHASES     (90.0)  /* new moons, quarters, full moons */
+#define SWH_LUNATION_TITHIS     (12.0)  /* tithis */
+
+struct swh_lunation
+{
+    int lunation;   /* Lunation number, 0 from new moon of 2000 Jan 6 */
+    int index;      /* Division entered, 0 at new moon */
+    double jd;      /* Julian day number (UT) */
+};
+
+/** @brief Find next time the Moon reaches an elongation from the Sun
+ *
+ * Same as swh_next_aspect_with (SE_MOON, aspect elong, SE_SUN), but each
+ * lunation is predicted with the mean synodic month, then bracketed and
+ * refined with a few calculations.
+ *
+ * For example, 0 for new moon, 90 for first quarter, 180 for full moon,
+ * 270 for last quarter, or multiples of 12 for tithis.
+ *
+ * @param elong Elongation of the Moon, in degrees
+ * @param jdstart Julian day number, when search is starting
+ * @param backw Search before jdstart [1], or after [0] (boolean)
+ * @param flags Calculation flags, see swisseph docs
+ * @param jdret Julian day number found
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_next_lunation(
+    double elong,
+    double jdstart,
+    int backw,
+    int flags,
+    double* jdret,
+    char* err);
+
+/** @brief Scan divisions of lunar months
+ *
+ * Lunar months are divided in equal parts of given width (in degrees of
+ * elongation of the Moon from the Sun, starting at new moon), and the
+ * callback is called with each entry in a division within the time range,
+ * in chronological order. If it returns non-zero, the scan stops.
+ *
+ * Each event is predicted with the mean synodic month, then bracketed and
+ * refined as with swh_next_lunation.
+ *
+ * @param width Width of divisions, in degrees (SWH_LUNATION_*), 360 must
+ * be a multiple of it
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with arg and each event
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 3 if width is invalid
+ */
+int swh_lunation_scan(
+    double width,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_lunation* lun),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHLUNATION_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,304 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcontext.h"
+#include "swhmidpoint.h"
+#include "swhsearch.h"
+#include "swhstats.h"
+
+/* step of the scan, in days */
+#define STEP    (0.5)
+
+int _swh_midpoints_cmp(const void* a, const void* b)
+{
+    const double x = ((const struct swh_midpoint*) a)->lon;
+    const double y = ((const struct swh_midpoint*) b)->lon;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+int swh_midpoints_init(
+    struct swh_midpoints* mp,
+    const double* points,
+    int npoints,
+    double dial,
+    char* err)
+{
+    const int nd = dial > 0 ? (int) floor((360 / dial) + 0.5) : 0;
+    int i, j, k = 0;
+
+    assert(mp);
+    assert(points);
+    assert(err);
+
+    memset(mp, 0, sizeof(struct swh_midpoints));
+    if (nd < 1 || fabs((nd * dial) - 360) > 1e-9) {
+        sprintf(err, "invalid argument");
+        return 3;
+    }
+    mp->dial = 360.0 / nd;
+    if (npoints < 2)
+        return 0;
+    mp->v = malloc(sizeof(struct swh_midpoint) * npoints * (npoints - 1) / 2);
+    if (!mp->v) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    for (i = 0; i < npoints; ++i) {
+        for (j = i + 1; j < npoints; ++j) {
+            const double m = swe_degnorm(points[i]
+                + (swe_difdeg2n(points[j], points[i]) / 2));
+            mp->v[k].lon = fmod(m, mp->dial);
+            mp->v[k].a = i;
+            mp->v[k].b = j;
+            ++k;
+        }
+    }
+    mp->n = k;
+    qsort(mp->v, k, sizeof(struct swh_midpoint), &_swh_midpoints_cmp);
+    return 0;
+}
+
+void swh_midpoints_free(struct swh_midpoints* mp)
+{
+    assert(mp);
+    if (mp->v)
+        free(mp->v);
+    mp->v = NULL;
+    mp->n = 0;
+}
+
+/* first midpoint at or after lon on dial (or after, if strict) */
+int _swh_midpoints_bound(const struct swh_midpoints* mp, double lon,
+                         int strict)
+{
+    int lo = 0, hi = mp->n;
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) / 2);
+        if (strict ? mp->v[mid].lon <= lon : mp->v[mid].lon < lon)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* append midpoints in [lo;hi] */
+int _swh_midpoints_range(
+    const struct swh_midpoints* mp,
+    double lo,
+    double hi,
+    int* ret,
+    int max,
+    int n)
+{
+    int i;
+    for (i = _swh_midpoints_bound(mp, lo, 0);
+         i < mp->n && mp->v[i].lon <= hi; ++i) {
+        if (n < max)
+            ret[n] = i;
+        ++n;
+    }
+    return n;
+}
+
+int swh_midpoints_within(
+    const struct swh_midpoints* mp,
+    double lon,
+    double orb,
+    int* ret,
+    int max)
+{
+    const double d = mp->dial;
+    const double x = fmod(swe_degnorm(lon), d);
+    int n = 0;
+
+    assert(mp);
+    assert(ret || !max);
+
+    orb = fabs(orb);
+    if (2 * orb >= d)
+        return _swh_midpoints_range(mp, 0, d, ret, max, 0);
+    if (x - orb < 0) {
+        n = _swh_midpoints_range(mp, x - orb + d, d, ret, max, n);
+        return _swh_midpoints_range(mp, 0, x + orb, ret, max, n);
+    }
+    if (x + orb >= d) {
+        n = _swh_midpoints_range(mp, x - orb, d, ret, max, n);
+        return _swh_midpoints_range(mp, 0, x + orb - d, ret, max, n);
+    }
+    return _swh_midpoints_range(mp, x - orb, x + orb, ret, max, n);
+}
+
+typedef struct
+{
+    const struct swh_midpoints* mp;
+    int planet;
+    int flags;
+    double lon;     /* longitude targeted */
+    struct swh_events evts;
+    int (*callback)(void* arg, const struct swh_midpoint_transit* tr);
+    void* arg;
+} swh_midpoints_args_t;
+
+/* distance to target */
+int _swh_midpoints(double t, void* fargs, double* ret, char* err)
+{
+    const swh_midpoints_args_t* args = fargs;
+    double res[6] = {0,0,0,0,0,0};
+
+    int x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
+    if (x < 0)
+        return x;
+    ret[0] = swe_difdeg2n(res[0], args->lon);
+    ret[1] = res[3];
+    return 0;
+}
+
+/* longitude and speed of the planet */
+int _swh_midpoints_pos(void* fargs, int i, double t, double* ret, char* err)
+{
+    const swh_midpoints_args_t* args = fargs;
+    double res[6] = {0,0,0,0,0,0};
+
+    (void) i;
+    if (swh_cache_calc_ut(t, args->planet, args->flags, res, err) < 0)
+        return 1;
+    ret[0] = res[0];
+    ret[1] = res[3];
+    return 0;
+}
+
+/* midpoints crossed on a monotonic part of the path */
+int _swh_midpoints_segment(
+    void* fargs,
+    int ipath,
+    double t1,
+    const double* p1,
+    double t2,
+    const double* p2,
+    char* err)
+{
+    swh_midpoints_args_t* args = fargs;
+    const struct swh_midpoints* mp = args->mp;
+    const double d = mp->dial;
+    const double a = fmod(p1[0], d);
+    const double span = swe_difdeg2n(p2[0], p1[0]);
+    const double b = a + span;
+    const double lo = span < 0 ? b : a;
+    const double hi = span < 0 ? a : b;
+    double base;
+    int i;
+
+    (void) ipath;
+    if (span == 0)
+        return 0;
+    /* crossed at end of step, not at start */
+    for (base = floor(lo / d) * d; base <= hi; base += d) {
+        for (i = _swh_midpoints_bound(mp, lo - base, span > 0);
+             i < mp->n; ++i) {
+            const double v = base + mp->v[i].lon;
+            double f1[2] = {0, 0}, f2[2] = {0, 0};
+            struct swh_midpoint_transit* e;
+            if (span > 0 ? v > hi : v >= hi)
+                break;
+            e = _swh_events_add(&args->evts, err);
+            if (!e)
+                return 1;
+            args->lon = swe_degnorm(p1[0] + (v - a));
+            f1[0] = swe_difdeg2n(p1[0], args->lon);
+            f1[1] = p1[1];
+            f2[0] = swe_difdeg2n(p2[0], args->lon);
+            f2[1] = p2[1];
+            if (f1[0] == 0)
+                e->jd = t1;
+            else if (f2[0] == 0)
+                e->jd = t2;
+            else if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_midpoints,
+                                          args, &e->jd, err))
+                return 1;
+            e->i = i;
+            e->lon = args->lon;
+        }
+    }
+    return 0;
+}
+
+/* transits of the step, in chronological order */
+int _swh_midpoints_done(void* fargs, char* err)
+{
+    swh_midpoints_args_t* args = fargs;
+    int k;
+
+    (void) err;
+    _swh_events_sort(&args->evts);
+    for (k = 0; k < args->evts.n; ++k) {
+        if (args->callback(args->arg, _swh_events_get(&args->evts, k)))
+            return 2;
+    }
+    args->evts.n = 0;
+    return 0;
+}
+
+int swh_midpoints_scan(
+    const struct swh_midpoints* mp,
+    int planet,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_midpoint_transit* tr),
+    void* arg,
+    char* err)
+{
+    swh_midpoints_args_t args = {NULL, 0, 0, 0,
+        SWH_EVENTS_INIT(struct swh_midpoint_transit), NULL, NULL};
+    int x;
+
+    assert(mp);
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    if (!mp->n)
+        return 0;
+    SWH_STATS_ENTER();
+    args.mp = mp;
+    args.planet = planet;
+    args.flags = flags | SEFLG_SPEED;
+    args.callback = callback;
+    args.arg = arg;
+    x = _swh_path_walk(1, jdstart, jdend, STEP, &_swh_midpoints_pos,
+                       &_swh_midpoints_segment, &_swh_midpoints_done, &args,
+                       err);
+    SWH_STATS_LEAVE();
+    _swh_events_free(&args.evts);
+    return x == 1 ? 1 : 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
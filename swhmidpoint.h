@@ -0,0 +1,128 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHMIDPOINT_H
+#define SWHMIDPOINT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct swh_midpoint
+{
+    double lon;     /* Midpoint, modulo dial [0;dial[ */
+    int a;          /* Index of first point */
+    int b;          /* Index of second point */
+};
+
+/** @brief Midpoints of points, sorted on a dial
+ *
+ * Holds the midpoints of all pairs of points (on the shorter arc), reduced
+ * modulo the dial (360, 90, 45 degrees, etc), and sorted.
+ */
+struct swh_midpoints
+{
+    double dial;    /* Size of dial, in degrees */
+    int n;          /* Number of midpoints */
+    struct swh_midpoint* v; /* Midpoints, sorted by longitude */
+};
+
+struct swh_midpoint_transit
+{
+    int i;          /* Index of midpoint in structure */
+    double jd;      /* Julian day number */
+    double lon;     /* Longitude of transiting planet */
+};
+
+/** @brief Build the sorted midpoints of points
+ *
+ * @param mp Midpoints, to be freed with swh_midpoints_free
+ * @param points Longitudes of points
+ * @param npoints Number of points
+ * @param dial Size of dial, in degrees, 360 must be a multiple of it
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 3 if dial is invalid
+ */
+int swh_midpoints_init(
+    struct swh_midpoints* mp,
+    const double* points,
+    int npoints,
+    double dial,
+    char* err);
+
+/** @brief Free sorted midpoints
+ * @param mp Midpoints
+ */
+void swh_midpoints_free(struct swh_midpoints* mp);
+
+/** @brief Find midpoints within orb of a longitude, on the dial
+ *
+ * Midpoints are found with a binary search, then read in order.
+ *
+ * @param mp Midpoints
+ * @param lon Longitude
+ * @param orb Orb, in degrees
+ * @param ret Indexes of midpoints found, along the dial from lon - orb
+ * @param max Size of ret
+ * @return Number of midpoints within orb (may be greater than max)
+ */
+int swh_midpoints_within(
+    const struct swh_midpoints* mp,
+    double lon,
+    double orb,
+    int* ret,
+    int max);
+
+/** @brief Scan transits of a planet to all midpoints, on the dial
+ *
+ * Find all times within a time range when a planet is conjunct a midpoint
+ * on the dial (hard aspects on the 90 degrees dial, etc). The path of the
+ * planet is sampled once, steps are split at stations, and midpoints
+ * crossed within a step are found in the sorted structure, then refined.
+ *
+ * The callback is called for each transit, in chronological order. If it
+ * returns non-zero, the scan stops.
+ *
+ * @param mp Midpoints
+ * @param planet Planet number (SE_*, etc)
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with arg and each transit
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_midpoints_scan(
+    const struct swh_midpoints* mp,
+    int planet,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_midpoint_transit* tr),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHMIDPOINT_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
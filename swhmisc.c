@@ -21,6 +21,13 @@
 #include <swephexp.h>
 
 #include "swhmisc.h"
+#include "swhstar.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
 
 int swh_calc_ut(
     double tjdut,
@@ -45,9 +52,13 @@ int swh_calc_ut(
     return swe_calc_ut(tjdut, planet, flags, res, err);
 }
 
+/* royal stars, looked up once per thread */
+static TLS struct swh_star _swh_royal_stars[4];
+static TLS int _swh_royal_stars_init = 0;
+
 int swh_saturn_4_stars( const double jd, const int flag, double* ret, char* err )
 {
-    char starbuf[50];
+    const char* names[4] = {"Aldebaran", "Regulus", "Antares", "Fomalhaut"};
     double xx[6];
     double* stars[2] = {0,0}; /* dummy assign */
     double midp, dist0, dist1, dist2;
@@ -59,29 +70,18 @@ int swh_saturn_4_stars( const double jd, const int flag, double* ret, char* err
         return -1;
     ret[0] = xx[0];
 
-    strcpy( starbuf, "Aldebaran" );
-    i = swe_fixstar_ut( starbuf, jd, flag, xx, err );
-    if ( i < 0 )
-        return -1;
-    ret[1] = xx[0];
-
-    strcpy( starbuf, "Regulus" );
-    i = swe_fixstar_ut( starbuf, jd, flag, xx, err );
-    if ( i < 0 )
-        return -1;
-    ret[2] = xx[0];
-
-    strcpy( starbuf, "Antares" );
-    i = swe_fixstar_ut( starbuf, jd, flag, xx, err );
-    if ( i < 0 )
-        return -1;
-    ret[3] = xx[0];
-
-    strcpy( starbuf, "Fomalhaut" );
-    i = swe_fixstar_ut( starbuf, jd, flag, xx, err );
-    if ( i < 0 )
-        return -1;
-    ret[4] = xx[0];
+    if ( !_swh_royal_stars_init || _swh_royal_stars[0].flags != flag )
+    {
+        for ( i = 0; i < 4; ++i )
+            swh_star_init( &_swh_royal_stars[i], names[i], flag );
+        _swh_royal_stars_init = 1;
+    }
+    for ( i = 0; i < 4; ++i )
+    {
+        if ( swh_star_calc_ut( &_swh_royal_stars[i], jd, xx, err ) < 0 )
+            return -1;
+        ret[i+1] = xx[0];
+    }
 
     /* Find nearest stars from Saturn */
     if ( ret[0] <= ret[1] || ret[0] > ret[4] )
@@ -67,6 +67,9 @@ int swh_calc_ut(
  *  The nearer of the stars Saturn is found, closer to 100 the index value is.
  *  Also, the index value is zero (0) exactly when saturn is at mid-point between
  *  the two nearest stars.
+ *
+ *  Positions of the stars are interpolated between days (see struct
+ *  swh_star), within about 0.006".
  */
 int swh_saturn_4_stars( const double jd, const int flag, double* ret, char* err );
 
@@ -0,0 +1,85 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Generate a station index for swh_next_retro.
+ *
+ * Usage: swhmkstations FILE [YEARSTART YEAREND [FLAGS [EPHEPATH]]]
+ *
+ * Flags default to SEFLG_SWIEPH|SEFLG_SPEED|SEFLG_NOGDEFL, as recommended
+ * for swh_next_retro. The index only answers searches with the same flags
+ * (see SWH_STATIONS_FLAGMASK).
+ *
+ * Bodies whose ephemeris is not available (asteroids) are skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <swephexp.h>
+
+#include "swhstations.h"
+
+int main(int argc, char* argv[])
+{
+    const int bodies[] = {SE_MERCURY, SE_VENUS, SE_MARS, SE_JUPITER,
+                          SE_SATURN, SE_URANUS, SE_NEPTUNE, SE_PLUTO,
+                          SE_CHIRON, SE_PHOLUS, SE_CERES, SE_PALLAS,
+                          SE_JUNO, SE_VESTA};
+    const int nbodies = sizeof(bodies) / sizeof(int);
+    int flags = SEFLG_SWIEPH | SEFLG_SPEED | SEFLG_NOGDEFL;
+    int planets[sizeof(bodies) / sizeof(int)];
+    int yearstart = 1800, yearend = 2400;
+    double jdstart, jdend;
+    double res[6];
+    char err[256] = {0};
+    int i, n = 0, x;
+
+    if (argc != 2 && (argc < 4 || argc > 6)) {
+        fprintf(stderr, "Usage: %s FILE [YEARSTART YEAREND [FLAGS"
+                " [EPHEPATH]]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 4) {
+        yearstart = atoi(argv[2]);
+        yearend = atoi(argv[3]);
+    }
+    if (argc >= 5)
+        flags = (int) strtol(argv[4], NULL, 0);
+    swe_set_ephe_path(argc == 6 ? argv[5] : NULL);
+    jdstart = swe_julday(yearstart, 1, 1, 0, SE_GREG_CAL);
+    jdend = swe_julday(yearend, 1, 1, 0, SE_GREG_CAL);
+
+    for (i = 0; i < nbodies; ++i) {
+        if (swe_calc_ut(jdstart, bodies[i], flags, res, err) < 0
+            || swe_calc_ut(jdend, bodies[i], flags, res, err) < 0) {
+            fprintf(stderr, "skipping body %d: %s\n", bodies[i], err);
+            continue;
+        }
+        planets[n++] = bodies[i];
+    }
+    x = swh_stations_make(argv[1], planets, n, jdstart, jdend, flags, err);
+    swe_close();
+    if (x) {
+        fprintf(stderr, "error: %s\n", err);
+        return 1;
+    }
+    return 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
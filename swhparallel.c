@@ -0,0 +1,344 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcheby.h"
+#include "swhcontext.h"
+#include "swhparallel.h"
+
+/* overlap of chunks, in days */
+#define OVERLAP     (1.0)
+/* aspects found twice within that time are the same, in days */
+#define SAMEHIT     (1.0/(24*60))
+/* minimum length of chunks, in days */
+#define MINCHUNK    (30.0)
+/* chunks per worker, for load balancing */
+#define CHUNKS      (8)
+
+#ifdef _WIN32
+typedef HANDLE swh_thread_t;
+typedef CRITICAL_SECTION swh_mutex_t;
+#define swh_mutex_init(m)       InitializeCriticalSection(m)
+#define swh_mutex_lock(m)       EnterCriticalSection(m)
+#define swh_mutex_unlock(m)     LeaveCriticalSection(m)
+#define swh_mutex_destroy(m)    DeleteCriticalSection(m)
+#else
+typedef pthread_t swh_thread_t;
+typedef pthread_mutex_t swh_mutex_t;
+#define swh_mutex_init(m)       pthread_mutex_init((m), NULL)
+#define swh_mutex_lock(m)       pthread_mutex_lock(m)
+#define swh_mutex_unlock(m)     pthread_mutex_unlock(m)
+#define swh_mutex_destroy(m)    pthread_mutex_destroy(m)
+#endif
+
+int swh_ncpus(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int) si.dwNumberOfProcessors : 1;
+#else
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+#endif
+}
+
+typedef struct
+{
+    struct swh_aspect_hit* hits;
+    int nhits;
+    int maxhits;
+    int nomem;
+} swh_aspect_scan_chunk_t;
+
+typedef struct
+{
+    /* scan arguments */
+    const int* planets;
+    int nplanets;
+    const int* others;
+    int nothers;
+    const double* aspects;
+    int naspects;
+    double jdstart;
+    double jdend;
+    int flags;
+    void (*init)(void* initarg);
+    void* initarg;
+    struct swh_search_ctx* ctx;
+    /* work queue */
+    swh_aspect_scan_chunk_t* chunks;
+    int nchunks;
+    double chunklen;
+    int next;
+    int failed;
+    char err[256];
+    swh_mutex_t lock;
+} swh_aspect_scan_mt_t;
+
+int _swh_aspect_scan_mt_cb(void* arg, const struct swh_aspect_hit* hit)
+{
+    swh_aspect_scan_chunk_t* c = arg;
+    if (c->nhits == c->maxhits) {
+        struct swh_aspect_hit* h = realloc(c->hits,
+            sizeof(struct swh_aspect_hit) * (c->maxhits + 64));
+        if (!h) {
+            c->nomem = 1;
+            return 1;
+        }
+        c->hits = h;
+        c->maxhits += 64;
+    }
+    c->hits[c->nhits++] = *hit;
+    return 0;
+}
+
+void _swh_aspect_scan_mt_work(swh_aspect_scan_mt_t* w)
+{
+    int i, x;
+    char err[256];
+
+    if (w->init)
+        (*w->init)(w->initarg);
+    /* bound by the context of the caller, if any */
+    if (w->ctx)
+        _swh_search_ctx_share(w->ctx);
+    for (;;) {
+        double t1, t2;
+        swh_mutex_lock(&w->lock);
+        i = w->failed ? w->nchunks : w->next++;
+        swh_mutex_unlock(&w->lock);
+        if (i >= w->nchunks)
+            break;
+        t1 = w->jdstart + (i * w->chunklen);
+        t2 = i == w->nchunks - 1 ? w->jdend :
+            t1 + w->chunklen + OVERLAP;
+        if (t2 > w->jdend)
+            t2 = w->jdend;
+        memset(err, 0, 256);
+        x = swh_aspect_scan(w->planets, w->nplanets, w->others, w->nothers,
+                            w->aspects, w->naspects, t1, t2, w->flags,
+                            &_swh_aspect_scan_mt_cb, &w->chunks[i], err);
+        if (!x && w->chunks[i].nomem) {
+            strcpy(err, "nomem");
+            x = 1;
+        }
+        if (x) {
+            swh_mutex_lock(&w->lock);
+            if (!w->failed) {
+                w->failed = 1;
+                strcpy(w->err, err);
+            }
+            swh_mutex_unlock(&w->lock);
+            break;
+        }
+    }
+    if (w->ctx)
+        _swh_search_ctx_share(NULL);
+    swh_cache_enable(0);
+    swh_cheby_enable(0);
+    swe_close();
+}
+
+#ifdef _WIN32
+unsigned __stdcall _swh_aspect_scan_mt_thread(void* arg)
+{
+    _swh_aspect_scan_mt_work(arg);
+    return 0;
+}
+#else
+void* _swh_aspect_scan_mt_thread(void* arg)
+{
+    _swh_aspect_scan_mt_work(arg);
+    return NULL;
+}
+#endif
+
+int _swh_aspect_hit_order(const void* a, const void* b)
+{
+    const struct swh_aspect_hit* x = a;
+    const struct swh_aspect_hit* y = b;
+    if (x->jd != y->jd)
+        return x->jd < y->jd ? -1 : 1;
+    if (x->planet != y->planet)
+        return x->planet < y->planet ? -1 : 1;
+    if (x->other != y->other)
+        return x->other < y->other ? -1 : 1;
+    if (x->aspect != y->aspect)
+        return x->aspect < y->aspect ? -1 : 1;
+    return 0;
+}
+
+int swh_aspect_scan_mt(
+    const int* planets,
+    int nplanets,
+    const int* others,
+    int nothers,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int nthreads,
+    void (*init)(void* initarg),
+    void* initarg,
+    int (*callback)(void* arg, const struct swh_aspect_hit* hit),
+    void* arg,
+    char* err)
+{
+    swh_aspect_scan_mt_t w;
+    swh_thread_t* threads = NULL;
+    struct swh_aspect_hit* hits = NULL;
+    int nhits = 0, nstarted = 0;
+    int i, j, x = 0;
+
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    if (nthreads <= 0)
+        nthreads = swh_ncpus();
+    memset(&w, 0, sizeof(w));
+    w.planets = planets;
+    w.nplanets = nplanets;
+    w.others = others;
+    w.nothers = nothers;
+    w.aspects = aspects;
+    w.naspects = naspects;
+    w.jdstart = jdstart;
+    w.jdend = jdend;
+    w.flags = flags;
+    w.init = init;
+    w.initarg = initarg;
+    w.ctx = swh_search_ctx_get();
+    w.nchunks = nthreads * CHUNKS;
+    if ((jdend - jdstart) / w.nchunks < MINCHUNK)
+        w.nchunks = (int) ceil((jdend - jdstart) / MINCHUNK);
+    if (w.nchunks < nthreads)
+        nthreads = w.nchunks;
+    w.chunklen = (jdend - jdstart) / w.nchunks;
+    w.chunks = calloc(w.nchunks, sizeof(swh_aspect_scan_chunk_t));
+    threads = calloc(nthreads, sizeof(swh_thread_t));
+    if (!w.chunks || !threads) {
+        sprintf(err, "nomem");
+        x = 1;
+        goto end;
+    }
+    swh_mutex_init(&w.lock);
+    for (i = 0; i < nthreads; ++i) {
+#ifdef _WIN32
+        threads[i] = (HANDLE) _beginthreadex(NULL, 0,
+            &_swh_aspect_scan_mt_thread, &w, 0, NULL);
+        if (!threads[i])
+            break;
+#else
+        if (pthread_create(&threads[i], NULL,
+                           &_swh_aspect_scan_mt_thread, &w))
+            break;
+#endif
+        ++nstarted;
+    }
+    if (!nstarted) {
+        swh_mutex_destroy(&w.lock);
+        sprintf(err, "unable to start threads");
+        x = 1;
+        goto end;
+    }
+    for (i = 0; i < nstarted; ++i) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    swh_mutex_destroy(&w.lock);
+    if (w.failed) {
+        strcpy(err, w.err);
+        x = 1;
+        goto end;
+    }
+    /* merge chunks, and drop aspects found twice */
+    for (i = 0; i < w.nchunks; ++i)
+        nhits += w.chunks[i].nhits;
+    hits = malloc(sizeof(struct swh_aspect_hit) * (nhits + 1));
+    if (!hits) {
+        sprintf(err, "nomem");
+        x = 1;
+        goto end;
+    }
+    nhits = 0;
+    for (i = 0; i < w.nchunks; ++i) {
+        if (!w.chunks[i].nhits)
+            continue;
+        memcpy(&hits[nhits], w.chunks[i].hits,
+               sizeof(struct swh_aspect_hit) * w.chunks[i].nhits);
+        nhits += w.chunks[i].nhits;
+    }
+    qsort(hits, nhits, sizeof(struct swh_aspect_hit),
+          &_swh_aspect_hit_order);
+    for (i = 0; i < nhits; ++i) {
+        int dupl = 0;
+        for (j = i - 1; j >= 0 && hits[i].jd - hits[j].jd < SAMEHIT; --j) {
+            if (hits[j].planet == hits[i].planet
+                && hits[j].other == hits[i].other
+                && hits[j].aspect == hits[i].aspect) {
+                dupl = 1;
+                break;
+            }
+        }
+        if (dupl)
+            continue;
+        if ((*callback)(arg, &hits[i]))
+            break;
+    }
+  end:
+    if (w.chunks) {
+        for (i = 0; i < w.nchunks; ++i) {
+            if (w.chunks[i].hits)
+                free(w.chunks[i].hits);
+        }
+        free(w.chunks);
+    }
+    if (threads)
+        free(threads);
+    if (hits)
+        free(hits);
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
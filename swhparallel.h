@@ -0,0 +1,96 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHPARALLEL_H
+#define SWHPARALLEL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "swhsearch.h"
+
+/** @brief Get number of processors available
+ * @return Number of online processors, at least 1
+ */
+int swh_ncpus(void);
+
+/** @brief Find all aspects between objects within a time range, in parallel
+ *
+ * Same as swh_aspect_scan, but the time range is split in chunks that are
+ * scanned by a pool of worker threads. Chunks overlap slightly, and aspects
+ * found twice at their boundaries are reported once.
+ *
+ * Swisseph settings (ephemeris path, sidereal mode, topocentric position),
+ * the ephemeris cache and interpolation are kept per thread: the init
+ * function, if not NULL, is called by each worker thread before it starts,
+ * and should set them up as needed. Each worker closes its ephemeris files
+ * and frees its cache and interpolation segments when done.
+ *
+ * The search context of the calling thread, if any, is shared by the
+ * workers: its limits apply to the whole scan, and the scan fails as soon
+ * as one worker is interrupted.
+ * @see swh_search_ctx_set()
+ *
+ * The callback is called from the calling thread, in chronological order,
+ * once all workers are done.
+ *
+ * @see swh_aspect_scan()
+ *
+ * @param planets Planet numbers
+ * @param nplanets Number of planets
+ * @param others Other planet numbers
+ * @param nothers Number of other planets
+ * @param aspects Aspects, in degrees [0;180]
+ * @param naspects Number of aspects
+ * @param jdstart Julian day number, when search is starting
+ * @param jdend Julian day number, when search is ending
+ * @param flags Calculation flags, see swisseph docs
+ * @param nthreads Number of worker threads, or 0 for one per processor
+ * @param init Function called by each worker when starting, or NULL
+ * @param initarg Argument passed to init function
+ * @param callback Function called for each aspect found
+ * @param arg Argument passed to callback function
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_aspect_scan_mt(
+    const int* planets,
+    int nplanets,
+    const int* others,
+    int nothers,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int nthreads,
+    void (*init)(void* initarg),
+    void* initarg,
+    int (*callback)(void* arg, const struct swh_aspect_hit* hit),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHPARALLEL_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
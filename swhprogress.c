@@ -0,0 +1,324 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcontext.h"
+#include "swhprogress.h"
+#include "swhsearch.h"
+#include "swhstats.h"
+
+double swh_progress_jd(double jdnatal, double jd, double year)
+{
+    return jdnatal + ((jd - jdnatal) / (year > 0 ? year : SWH_PROGRESS_YEAR));
+}
+
+double swh_progress_realjd(double jdnatal, double jdprog, double year)
+{
+    return jdnatal + ((jdprog - jdnatal)
+                      * (year > 0 ? year : SWH_PROGRESS_YEAR));
+}
+
+int swh_progress_init(
+    struct swh_progress* pg,
+    double jdnatal,
+    double year,
+    const int* planets,
+    int nplanets,
+    double jdstart,
+    double jdend,
+    int flags,
+    char* err)
+{
+    double res[6] = {0,0,0,0,0,0};
+    double p0, p1;
+    int i, r;
+
+    assert(pg);
+    assert(planets);
+    assert(err);
+
+    memset(pg, 0, sizeof(struct swh_progress));
+    if (nplanets < 0 || nplanets > SWH_PROGRESS_MAXPLANETS) {
+        sprintf(err, "invalid argument");
+        return 3;
+    }
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    pg->jdnatal = jdnatal;
+    pg->year = year > 0 ? year : SWH_PROGRESS_YEAR;
+    pg->flags = flags | SEFLG_SPEED;
+    pg->sun = -1;
+    for (i = 0; i < nplanets; ++i) {
+        pg->planets[i] = planets[i];
+        if (planets[i] == SE_SUN && pg->sun < 0)
+            pg->sun = i;
+    }
+    if (pg->sun < 0) {
+        pg->sun = nplanets;
+        pg->planets[nplanets++] = SE_SUN;
+    }
+    pg->nplanets = nplanets;
+    for (i = 0; i < nplanets; ++i) {
+        if (swh_cache_calc_ut(jdnatal, pg->planets[i], pg->flags, res,
+                              err) < 0)
+            return 1;
+        pg->natal[i] = res[0];
+    }
+    /* rows at whole progressed days around the range */
+    p0 = floor(swh_progress_jd(jdnatal, jdstart, pg->year));
+    p1 = ceil(swh_progress_jd(jdnatal, jdend, pg->year));
+    pg->jd0 = p0;
+    pg->nrows = (int) (p1 - p0) + 1;
+    pg->rows = malloc(sizeof(double) * 2 * nplanets * pg->nrows);
+    if (!pg->rows) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    for (r = 0; r < pg->nrows; ++r) {
+        for (i = 0; i < nplanets; ++i) {
+            double* row = &pg->rows[((r * nplanets) + i) * 2];
+            if (swh_cache_calc_ut(p0 + r, pg->planets[i], pg->flags, res,
+                                  err) < 0) {
+                swh_progress_free(pg);
+                return 1;
+            }
+            row[0] = res[0];
+            row[1] = res[3];
+        }
+    }
+    return 0;
+}
+
+void swh_progress_free(struct swh_progress* pg)
+{
+    assert(pg);
+    if (pg->rows)
+        free(pg->rows);
+    pg->rows = NULL;
+    pg->nrows = 0;
+}
+
+/* interpolate longitude and speed, in progressed time */
+int _swh_progress_interp(
+    const struct swh_progress* pg,
+    int i,
+    double jdprog,
+    double* ret)
+{
+    const double x = jdprog - pg->jd0;
+    int r = (int) floor(x);
+    const double* a;
+    const double* b;
+    double u, u2, u3, p0, p1;
+
+    if (r == pg->nrows - 1 && x == r)
+        --r;
+    if (r < 0 || r >= pg->nrows - 1)
+        return 1;
+    a = &pg->rows[((r * pg->nplanets) + i) * 2];
+    b = &pg->rows[(((r + 1) * pg->nplanets) + i) * 2];
+    u = x - r;
+    u2 = u * u;
+    u3 = u2 * u;
+    p0 = a[0];
+    p1 = a[0] + swe_difdeg2n(b[0], a[0]);
+    ret[0] = swe_degnorm(((2*u3 - 3*u2 + 1) * p0) + ((u3 - 2*u2 + u) * a[1])
+                         + ((-2*u3 + 3*u2) * p1) + ((u3 - u2) * b[1]));
+    ret[1] = ((6*u2 - 6*u) * (p0 - p1)) + ((3*u2 - 4*u + 1) * a[1])
+        + ((3*u2 - 2*u) * b[1]);
+    return 0;
+}
+
+int swh_progress_pos(
+    const struct swh_progress* pg,
+    int i,
+    double jd,
+    int directed,
+    double* ret,
+    char* err)
+{
+    const double jdprog = swh_progress_jd(pg->jdnatal, jd, pg->year);
+
+    assert(pg);
+    assert(i >= 0 && i < pg->nplanets);
+    assert(ret);
+    assert(err);
+
+    if (_swh_progress_interp(pg, directed ? pg->sun : i, jdprog, ret)) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    if (directed)
+        ret[0] = swe_degnorm(pg->natal[i] + ret[0] - pg->natal[pg->sun]);
+    ret[1] /= pg->year;
+    return 0;
+}
+
+typedef struct
+{
+    const struct swh_progress* pg;
+    int i;
+    int directed;
+    double lon;     /* longitude targeted */
+    const double* points;
+    int npoints;
+    const double* aspects;
+    int naspects;
+    struct swh_events evts;
+    int (*callback)(void* arg, const struct swh_progress_aspect* pa);
+    void* arg;
+} swh_progress_args_t;
+
+/* distance to target */
+int _swh_progress(double t, void* fargs, double* ret, char* err)
+{
+    const swh_progress_args_t* args = fargs;
+    double pos[2];
+
+    if (swh_progress_pos(args->pg, args->i, t, args->directed, pos, err))
+        return 1;
+    ret[0] = swe_difdeg2n(pos[0], args->lon);
+    ret[1] = pos[1];
+    return 0;
+}
+
+/* position of a planet */
+int _swh_progress_pos(void* fargs, int i, double t, double* ret, char* err)
+{
+    const swh_progress_args_t* args = fargs;
+
+    return swh_progress_pos(args->pg, i, t, args->directed, ret, err);
+}
+
+/* aspects on a monotonic part of the path of a planet */
+int _swh_progress_segment(
+    void* fargs,
+    int i,
+    double t1,
+    const double* p1,
+    double t2,
+    const double* p2,
+    char* err)
+{
+    swh_progress_args_t* args = fargs;
+    int j, k, m;
+
+    args->i = i;
+    for (j = 0; j < args->npoints; ++j) {
+        for (k = 0; k < args->naspects; ++k) {
+            const double asp = swe_degnorm(args->aspects[k]);
+            for (m = 0; m < (asp == 0 || asp == 180 ? 1 : 2); ++m) {
+                double f1[2] = {0, 0}, f2[2] = {0, 0};
+                struct swh_progress_aspect* e;
+                args->lon = swe_degnorm(args->points[j] + (m ? -asp : asp));
+                f1[0] = swe_difdeg2n(p1[0], args->lon);
+                f1[1] = p1[1];
+                f2[0] = swe_difdeg2n(p2[0], args->lon);
+                f2[1] = p2[1];
+                if (fabs(f1[0]) > 90 || f1[0] == 0
+                    || (f2[0] != 0 && (f1[0] < 0) == (f2[0] < 0)))
+                    continue;
+                e = _swh_events_add(&args->evts, err);
+                if (!e)
+                    return 1;
+                if (f2[0] == 0)
+                    e->jd = t2;
+                else if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_progress,
+                                              args, &e->jd, err))
+                    return 1;
+                e->planet = i;
+                e->point = j;
+                e->aspect = asp;
+            }
+        }
+    }
+    return 0;
+}
+
+/* aspects of the step, in chronological order */
+int _swh_progress_done(void* fargs, char* err)
+{
+    swh_progress_args_t* args = fargs;
+    int k;
+
+    (void) err;
+    _swh_events_sort(&args->evts);
+    for (k = 0; k < args->evts.n; ++k) {
+        if (args->callback(args->arg, _swh_events_get(&args->evts, k)))
+            return 2;
+    }
+    args->evts.n = 0;
+    return 0;
+}
+
+int swh_progress_scan(
+    const struct swh_progress* pg,
+    const double* points,
+    int npoints,
+    const double* aspects,
+    int naspects,
+    int directed,
+    double jdstart,
+    double jdend,
+    int (*callback)(void* arg, const struct swh_progress_aspect* pa),
+    void* arg,
+    char* err)
+{
+    swh_progress_args_t args = {NULL, 0, 0, 0, NULL, 0, NULL, 0,
+        SWH_EVENTS_INIT(struct swh_progress_aspect), NULL, NULL};
+    int x;
+
+    assert(pg);
+    assert(points);
+    assert(aspects);
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    args.pg = pg;
+    args.directed = directed;
+    args.points = points;
+    args.npoints = npoints;
+    args.aspects = aspects;
+    args.naspects = naspects;
+    args.callback = callback;
+    args.arg = arg;
+    /* one progressed day at a time */
+    x = _swh_path_walk(pg->nplanets, jdstart, jdend, pg->year,
+                       &_swh_progress_pos, &_swh_progress_segment,
+                       &_swh_progress_done, &args, err);
+    SWH_STATS_LEAVE();
+    _swh_events_free(&args.evts);
+    return x == 1 ? 1 : 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,172 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHPROGRESS_H
+#define SWHPROGRESS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Default length of a progressed year (tropical year), in days */
+#define SWH_PROGRESS_YEAR       (365.24219)
+
+/** @brief Maximum number of planets of a progressed path */
+#define SWH_PROGRESS_MAXPLANETS 32
+
+/** @brief Progressed path of planets
+ *
+ * Secondary progressions map each year of life to a day after birth (day
+ * for a year). The positions of the planets are calculated once for each
+ * progressed day of a time range (a life fits in about 90 days), and are
+ * interpolated in between (cubic Hermite, with speeds). Solar arc
+ * directions move all natal positions by the arc of the progressed Sun.
+ *
+ * The Sun is always part of the path, it is added to the planets if
+ * missing.
+ */
+struct swh_progress
+{
+    double jdnatal;     /* Julian day number of birth */
+    double year;        /* Length of a progressed year, in days */
+    int flags;          /* Calculation flags */
+    int nplanets;       /* Number of planets */
+    int sun;            /* Index of the Sun in planets */
+    int planets[SWH_PROGRESS_MAXPLANETS+1]; /* Planet numbers */
+    double natal[SWH_PROGRESS_MAXPLANETS+1]; /* Natal longitudes */
+    double jd0;         /* Progressed Julian day of first row */
+    int nrows;          /* Number of rows (days) */
+    double* rows;       /* Longitudes and speeds, per day and planet */
+};
+
+struct swh_progress_aspect
+{
+    int planet;     /* Index of progressed (or directed) planet in path */
+    int point;      /* Index of natal point */
+    double aspect;  /* Aspect, in degrees */
+    double jd;      /* Julian day number (real time) */
+};
+
+/** @brief Get progressed time of a real time
+ * @param jdnatal Julian day number of birth
+ * @param jd Julian day number
+ * @param year Length of a progressed year, or 0 for default
+ * @return Progressed Julian day number
+ */
+double swh_progress_jd(double jdnatal, double jd, double year);
+
+/** @brief Get real time of a progressed time
+ * @param jdnatal Julian day number of birth
+ * @param jdprog Progressed Julian day number
+ * @param year Length of a progressed year, or 0 for default
+ * @return Julian day number
+ */
+double swh_progress_realjd(double jdnatal, double jdprog, double year);
+
+/** @brief Calculate the progressed path of planets
+ *
+ * @param pg Progressed path, to be freed with swh_progress_free
+ * @param jdnatal Julian day number of birth
+ * @param year Length of a progressed year, or 0 for default
+ * @param planets Planet numbers (the Sun is added if missing)
+ * @param nplanets Number of planets
+ * @param jdstart Julian day number, start of range (real time)
+ * @param jdend Julian day number, end of range (real time)
+ * @param flags Calculation flags, see swisseph docs
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 3 if too many planets
+ */
+int swh_progress_init(
+    struct swh_progress* pg,
+    double jdnatal,
+    double year,
+    const int* planets,
+    int nplanets,
+    double jdstart,
+    double jdend,
+    int flags,
+    char* err);
+
+/** @brief Free the progressed path of planets
+ * @param pg Progressed path
+ */
+void swh_progress_free(struct swh_progress* pg);
+
+/** @brief Get progressed (or directed) position of a planet
+ *
+ * @param pg Progressed path
+ * @param i Index of planet in path
+ * @param jd Julian day number (real time), within range of path
+ * @param directed Solar arc direction [1], or progression [0] (boolean)
+ * @param ret Longitude, and speed per real day, declared as double[2]
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 if out of range
+ */
+int swh_progress_pos(
+    const struct swh_progress* pg,
+    int i,
+    double jd,
+    int directed,
+    double* ret,
+    char* err);
+
+/** @brief Scan progressed (or directed) aspects to natal points
+ *
+ * Find all exact aspects of the planets of the path to natal points, in
+ * real time within a range. The path is walked one progressed day at a
+ * time, steps are split at stations, and each crossing is refined on the
+ * interpolated positions. Aspects are matched both ways, as with
+ * swh_next_aspect_with.
+ *
+ * The callback is called for each aspect, in chronological order. If it
+ * returns non-zero, the scan stops.
+ *
+ * @param pg Progressed path
+ * @param points Natal points, longitudes [0;360[
+ * @param npoints Number of natal points
+ * @param aspects Aspects, in degrees
+ * @param naspects Number of aspects
+ * @param directed Solar arc directions [1], or progressions [0] (boolean)
+ * @param jdstart Julian day number, start of range (real time)
+ * @param jdend Julian day number, end of range (real time)
+ * @param callback Function called with arg and each aspect
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_progress_scan(
+    const struct swh_progress* pg,
+    const double* points,
+    int npoints,
+    const double* aspects,
+    int naspects,
+    int directed,
+    double jdstart,
+    double jdend,
+    int (*callback)(void* arg, const struct swh_progress_aspect* pa),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHPROGRESS_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -19,9 +19,17 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include <swephexp.h>
 
+#include "swhcache.h"
+#include "swhcheby.h"
+#include "swhcontext.h"
 #include "swhsearch.h"
+#include "swhstar.h"
+#include "swhstations.h"
+#include "swhstats.h"
 
 #define STEP    (0.5)
 #define INCH    ((1.0/(24*60*60))*5)
@@ -58,22 +66,255 @@ double swh_approx_retrotime(int pl)
     }
 }
 
-int swh_secsearch(
+/* margin on maximum speeds */
+#define VMAXMARGIN  (1.5)
+
+double swh_approx_maxspeed(int pl, int flags)
+{
+    if (flags & (SEFLG_TOPOCTR|SEFLG_BARYCTR|SEFLG_XYZ|SEFLG_RADIANS))
+        return 0;
+    if (flags & SEFLG_HELCTR) {
+        switch (pl) {
+        case SE_MERCURY: return 6.4 * VMAXMARGIN;
+        case SE_VENUS: return 1.62 * VMAXMARGIN;
+        case SE_EARTH: return 1.02 * VMAXMARGIN;
+        case SE_MARS: return 0.69 * VMAXMARGIN;
+        case SE_JUPITER: return 0.1 * VMAXMARGIN;
+        case SE_SATURN: return 0.04 * VMAXMARGIN;
+        case SE_URANUS: return 0.014 * VMAXMARGIN;
+        case SE_NEPTUNE: return 0.007 * VMAXMARGIN;
+        case SE_PLUTO: return 0.007 * VMAXMARGIN;
+        case SE_CHIRON: return 0.06 * VMAXMARGIN;
+        case SE_PHOLUS: return 0.05 * VMAXMARGIN;
+        case SE_CERES: return 0.3 * VMAXMARGIN;
+        case SE_PALLAS: return 0.45 * VMAXMARGIN;
+        case SE_JUNO: return 0.5 * VMAXMARGIN;
+        case SE_VESTA: return 0.35 * VMAXMARGIN;
+        default: return 0;
+        }
+    }
+    switch (pl) {
+    case SE_SUN: return 1.02 * VMAXMARGIN;
+    case SE_MOON: return 15.4 * VMAXMARGIN;
+    case SE_MERCURY: return 2.2 * VMAXMARGIN;
+    case SE_VENUS: return 1.26 * VMAXMARGIN;
+    case SE_MARS: return 0.8 * VMAXMARGIN;
+    case SE_JUPITER: return 0.25 * VMAXMARGIN;
+    case SE_SATURN: return 0.14 * VMAXMARGIN;
+    case SE_URANUS: return 0.07 * VMAXMARGIN;
+    case SE_NEPTUNE: return 0.04 * VMAXMARGIN;
+    case SE_PLUTO: return 0.04 * VMAXMARGIN;
+    case SE_MEAN_NODE: return 0.06 * VMAXMARGIN;
+    case SE_TRUE_NODE: return 0.3 * VMAXMARGIN;
+    case SE_MEAN_APOG: return 0.12 * VMAXMARGIN;
+    case SE_CHIRON: return 0.16 * VMAXMARGIN;
+    case SE_PHOLUS: return 0.12 * VMAXMARGIN;
+    case SE_CERES: return 0.5 * VMAXMARGIN;
+    case SE_PALLAS: return 0.8 * VMAXMARGIN;
+    case SE_JUNO: return 0.6 * VMAXMARGIN;
+    case SE_VESTA: return 0.6 * VMAXMARGIN;
+    /* oscu apog, intp apog/perg, asteroids: unknown */
+    default: return 0;
+    }
+}
+
+/* Newton steps are accepted below that correction, in days */
+#define REFINE_TOL      (PRECISE/100)
+#define REFINE_MAXITER  64
+
+int _swh_secsearch_refine(
+    double t1,
+    const double f1[2],
+    double t2,
+    const double f2[2],
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double* ret,
+    char* err)
+{
+    double a = t2, fa = f2[0];
+    double b = t1, fb = f1[0];
+    double t, ft, dt;
+    double fv[2];
+    double w = fabs(b - a);
+    int side = 0;
+    int slow = 0;
+    int i, x;
+
+    /* start from the end nearest to the root */
+    if (fabs(f2[0]) < fabs(f1[0])) {
+        t = t2;
+        ft = f2[0];
+        dt = f2[1];
+    }
+    else {
+        t = t1;
+        ft = f1[0];
+        dt = f1[1];
+    }
+    for (i = 0; i < REFINE_MAXITER && fabs(b - a) > REFINE_TOL; ++i) {
+        const double lo = a < b ? a : b;
+        const double hi = a < b ? b : a;
+        double tn = 0;
+        int newton = 0;
+
+        if (slow >= 3) { /* safeguard, bisect */
+            tn = (a + b) / 2;
+            side = 0;
+            slow = 0;
+        }
+        else {
+            if (dt != HUGE_VAL && dt != 0) {
+                tn = t - (ft / dt);
+                newton = tn > lo && tn < hi;
+            }
+            if (!newton) /* regula falsi, with Illinois weights */
+                tn = ((a * fb) - (b * fa)) / (fb - fa);
+            else if (fabs(tn - t) <= REFINE_TOL) {
+                *ret = tn;
+                return 0;
+            }
+        }
+        fv[0] = 0;
+        fv[1] = HUGE_VAL;
+        SWH_STATS_INC(evals);
+        x = (*f)(tn, fargs, fv, err);
+        if (x)
+            return 1;
+        if (fv[0] == 0) {
+            *ret = tn;
+            return 0;
+        }
+        t = tn;
+        ft = fv[0];
+        dt = fv[1];
+        if ((ft < 0) == (fb < 0)) {
+            b = tn;
+            fb = ft;
+            if (!newton && side == -1)
+                fa /= 2;
+            side = newton ? 0 : -1;
+        }
+        else {
+            a = tn;
+            fa = ft;
+            if (!newton && side == 1)
+                fb /= 2;
+            side = newton ? 0 : 1;
+        }
+        slow = fabs(b - a) > w / 2 ? slow + 1 : 0;
+        w = fabs(b - a);
+    }
+    *ret = a + ((b - a) * (0 - fa)) / (fb - fa);
+    return 0;
+}
+
+/* Correct a root found with interpolated positions, with exact ones.
+ * If they do not confirm it, search again within the bracket [t1;t2]. */
+int _swh_secsearch_polish(
+    double t1,
+    double t2,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double* ret,
+    char* err)
+{
+    double t = *ret, dt;
+    double fv[2], fh[2];
+    const int bypass = swh_cheby_bypass(1);
+    const int sbypass = swh_star_bypass(1);
+    int i, x = 0, ok = 0;
+
+    for (i = 0; i < 4; ++i) {
+        fv[0] = 0;
+        fv[1] = HUGE_VAL;
+        SWH_STATS_INC(evals);
+        x = (*f)(t, fargs, fv, err);
+        if (x)
+            break;
+        if (fv[0] == 0) {
+            ok = 1;
+            break;
+        }
+        if (fv[1] == HUGE_VAL) { /* secant */
+            fh[0] = 0;
+            fh[1] = HUGE_VAL;
+            SWH_STATS_INC(evals);
+            x = (*f)(t + PRECISE, fargs, fh, err);
+            if (x)
+                break;
+            fv[1] = (fh[0] - fv[0]) / PRECISE;
+        }
+        if (fv[1] == 0)
+            break;
+        dt = fv[0] / fv[1];
+        t -= dt;
+        if (fabs(dt) <= REFINE_TOL) {
+            ok = 1;
+            break;
+        }
+    }
+    if (!x && (!ok || fabs(t - *ret) >= STEP)) {
+        double f1[2] = {0, HUGE_VAL};
+        double f2[2] = {0, HUGE_VAL};
+        SWH_STATS_INC(evals);
+        x = (*f)(t1, fargs, f1, err);
+        if (!x) {
+            SWH_STATS_INC(evals);
+            x = (*f)(t2, fargs, f2, err);
+        }
+        if (!x && (f1[0] * f2[0] > 0 || fabs(f1[0]) > 90
+                   || fabs(f2[0]) > 90)) {
+            sprintf(err, "root not confirmed by exact positions (%.8f)",
+                    *ret);
+            x = 1;
+        }
+        else if (!x)
+            x = _swh_secsearch_refine(t1, f1, t2, f2, f, fargs, &t, err);
+    }
+    swh_cheby_bypass(bypass);
+    swh_star_bypass(sbypass);
+    if (x)
+        return 1;
+    *ret = t;
+    return 0;
+}
+
+int swh_secsearch_refine(
+    double t1,
+    const double f1[2],
+    double t2,
+    const double f2[2],
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double* ret,
+    char* err)
+{
+    int x;
+    SWH_STATS_ENTER();
+    x = _swh_secsearch_refine(t1, f1, t2, f2, f, fargs, ret, err);
+    if (!x && (_swh_star_interpolated() || swh_cheby_enabled()))
+        x = _swh_secsearch_polish(t1, t2, f, fargs, ret, err);
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+int _swh_secsearch(
     double t1,
     int (*f)(double t, void* args, double* ret, char* err),
     void* fargs,
     double step,
     int (*nextep)(double step, void* args, double* t, char* err),
     double stop,
-    int recursive,
+    int refine,
     double* ret,
     char* err)
 {
     const double tstart = t1;
     double tstop = 0;
     double t2 = 0;
-    double f1 = 0;
-    double f2 = 0;
+    double f1[2] = {0, HUGE_VAL};
+    double f2[2] = {0, HUGE_VAL};
 
     unsigned int i = 0;
     int x = 0;
@@ -86,15 +327,17 @@ int swh_secsearch(
     if (stop)
         tstop = step > 0 ? t1 + fabs(stop) : t1 - fabs(stop);
 
-    x = (*f)(t1, fargs, &f1, err);
+    SWH_STATS_INC(evals);
+    x = (*f)(t1, fargs, f1, err);
     if (x)
         return 1;
 
-    while (f1 * f2 >= 0
-        || fabs(f2) > 90) /* trick swe_difdeg2n jumps */
+    while (f1[0] * f2[0] >= 0
+        || fabs(f2[0]) > 90) /* trick swe_difdeg2n jumps */
     {
         t2 = t1;
-        f2 = f1;
+        f2[0] = f1[0];
+        f2[1] = f1[1];
 
         if (nextep) {
             ++i;
@@ -112,23 +355,208 @@ int swh_secsearch(
                 t1 = tstop;
         }
 
-        x = (*f)(t1, fargs, &f1, err);
+        if (_swh_search_ctx_check(t1, err))
+            return 1;
+        f1[1] = HUGE_VAL;
+        SWH_STATS_INC(evals);
+        x = (*f)(t1, fargs, f1, err);
         if (x)
             return 1;
     }
 
-    if (recursive && fabs(step) > PRECISE)
-        return swh_secsearch(t1, f, fargs, -step/2, NULL, 0, 1, ret, err);
+    if (refine == SWH_REFINE_NEWTON)
+        return swh_secsearch_refine(t1, f1, t2, f2, f, fargs, ret, err);
+    if (refine && fabs(step) > PRECISE)
+        return swh_secsearch(t1, f, fargs, -step/2, NULL, 0, refine, ret,
+                             err);
     else {
-        double a = f1 - f2;
+        double a = f1[0] - f2[0];
         double b = t1 - t2;
-        double c = 0 - f2;
+        double c = 0 - f2[0];
         double d = (b * c) / a;
         *ret = d + t2;
+        if (_swh_star_interpolated() || swh_cheby_enabled())
+            return _swh_secsearch_polish(t1, t2, f, fargs, ret, err);
         return 0;
     }
 }
 
+int swh_secsearch(
+    double t1,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double step,
+    int (*nextep)(double step, void* args, double* t, char* err),
+    double stop,
+    int refine,
+    double* ret,
+    char* err)
+{
+    int x;
+    SWH_STATS_ENTER();
+    x = _swh_secsearch(t1, f, fargs, step, nextep, stop, refine, ret, err);
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+typedef struct
+{
+    int (*f)(double t, void* args, double* ret, char* err);
+    void* fargs;
+    double shift;
+} swh_secsearch2_args_t;
+
+/* the function of the other side */
+int _swh_secsearch2_other(double t, void* fargs, double* ret, char* err)
+{
+    const swh_secsearch2_args_t* args = fargs;
+    const int x = (*args->f)(t, args->fargs, ret, err);
+    if (x)
+        return x;
+    ret[0] = swe_difdeg2n(ret[0] + args->shift, 0);
+    return 0;
+}
+
+int _swh_secsearch2_refine(
+    double t1,
+    const double f1[2],
+    double t2,
+    const double f2[2],
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    int refine,
+    double* ret,
+    char* err)
+{
+    int x;
+
+    if (refine == SWH_REFINE_NEWTON)
+        return swh_secsearch_refine(t1, f1, t2, f2, f, fargs, ret, err);
+    /* search again, within the last step only */
+    x = swh_secsearch(t2, f, fargs, t1 - t2, NULL, fabs(t1 - t2), refine,
+                      ret, err);
+    if (x == 2) {
+        sprintf(err, "root not found within last step (%.8f)", t2);
+        return 1;
+    }
+    return x;
+}
+
+int _swh_secsearch2(
+    double t1,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double shift,
+    double step,
+    int (*nextep)(double step, void* args, double* t, char* err),
+    double stop,
+    int refine,
+    double* ret,
+    char* err)
+{
+    const double tstart = t1;
+    double tstop = 0;
+    double t2 = 0;
+    double f1[2] = {0, HUGE_VAL};
+    double f2[2] = {0, HUGE_VAL};
+    double g1[2] = {0, HUGE_VAL};
+    double g2[2] = {0, HUGE_VAL};
+    double r1 = 0, r2 = 0;
+    int c1 = 0, c2 = 0;
+    swh_secsearch2_args_t other = {f, fargs, shift};
+    /* both sides are the same function */
+    const int same = swe_difdeg2n(shift, 0) == 0;
+
+    unsigned int i = 0;
+    int x = 0;
+
+    assert(f);
+    assert(step);
+    assert(ret);
+    assert(err);
+
+    if (stop)
+        tstop = step > 0 ? t1 + fabs(stop) : t1 - fabs(stop);
+
+    SWH_STATS_INC(evals);
+    x = (*f)(t1, fargs, f1, err);
+    if (x)
+        return 1;
+    g1[0] = swe_difdeg2n(f1[0] + shift, 0);
+    g1[1] = f1[1];
+
+    while (!c1 && !c2)
+    {
+        t2 = t1;
+        f2[0] = f1[0];
+        f2[1] = f1[1];
+        g2[0] = g1[0];
+        g2[1] = g1[1];
+
+        if (nextep) {
+            ++i;
+            x = (*nextep)(step, fargs, &t1, err);
+            if (x)
+                return 1;
+        }
+        else
+            t1 = tstart + (++i * step);
+
+        if (stop) {
+            if (i > 1 && t2 == tstop)
+                return 2;
+            if (step > 0 ? t1 > tstop : t1 < tstop)
+                t1 = tstop;
+        }
+
+        if (_swh_search_ctx_check(t1, err))
+            return 1;
+        f1[1] = HUGE_VAL;
+        SWH_STATS_INC(evals);
+        x = (*f)(t1, fargs, f1, err);
+        if (x)
+            return 1;
+        g1[0] = swe_difdeg2n(f1[0] + shift, 0);
+        g1[1] = f1[1];
+
+        /* trick swe_difdeg2n jumps */
+        c1 = f1[0] * f2[0] < 0 && fabs(f2[0]) <= 90;
+        c2 = !same && g1[0] * g2[0] < 0 && fabs(g2[0]) <= 90;
+    }
+
+    if (c1 && _swh_secsearch2_refine(t1, f1, t2, f2, f, fargs, refine,
+                                     &r1, err))
+        return 1;
+    if (c2 && _swh_secsearch2_refine(t1, g1, t2, g2, &_swh_secsearch2_other,
+                                     &other, refine, &r2, err))
+        return 1;
+    if (c1 && c2)
+        *ret = (step > 0) == (r1 < r2) ? r1 : r2;
+    else
+        *ret = c1 ? r1 : r2;
+    return 0;
+}
+
+int swh_secsearch2(
+    double t1,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double shift,
+    double step,
+    int (*nextep)(double step, void* args, double* t, char* err),
+    double stop,
+    int refine,
+    double* ret,
+    char* err)
+{
+    int x;
+    SWH_STATS_ENTER();
+    x = _swh_secsearch2(t1, f, fargs, shift, step, nextep, stop, refine,
+                        ret, err);
+    SWH_STATS_LEAVE();
+    return x;
+}
+
 typedef struct
 {
     int planet;
@@ -143,7 +571,7 @@ int _swh_next_retro(double t, void* fargs, double* ret, char* err)
     const swh_next_retro_args_t* args = fargs;
     double res[6] = {0,0,0,0,0,0};
 
-    int x = swe_calc_ut(t, args->planet, args->flags, res, err);
+    int x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
     if (x < 0)
         return x;
     *ret = res[3];
@@ -175,6 +603,7 @@ int swh_next_retro(
     char* err)
 {
     int x;
+    double jd;
     const double step = swh_approx_retrotime(planet) || STEP;
     swh_next_retro_args_t args = {planet, jdstart, backw, stop, flags};
 
@@ -183,11 +612,19 @@ int swh_next_retro(
         return 3;
     }
 
-    x = swh_secsearch(jdstart, &_swh_next_retro, &args,
-                      backw ? -step : step, NULL, stop, 1, jdret, err);
+    if (!swh_stations_find(planet, jdstart, backw, flags, &jd)) {
+        if (stop && fabs(jd - jdstart) > fabs(stop))
+            return 2;
+        *jdret = jd;
+        x = 0;
+    }
+    else
+        x = swh_secsearch(jdstart, &_swh_next_retro, &args,
+                          backw ? -step : step, NULL, stop,
+                          SWH_REFINE_DEFAULT, jdret, err);
     if (!x && posret) {
-        int i = swe_calc_ut(*jdret, planet, flags, posret, err);
-        if (i < 0)
+        SWH_STATS_INC(calc);
+        if (swe_calc_ut(*jdret, planet, flags, posret, err) < 0)
             return 1;
     }
     return x;
@@ -257,10 +694,12 @@ int _swh_next_aspect(double t, void* fargs, double* ret, char* err)
     const swh_next_aspect_args_t* args = fargs;
     double res[6] = {0,0,0,0,0,0};
 
-    int x = swe_calc_ut(t, args->planet, args->flags, res, err);
+    int x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
     if (x < 0)
         return x;
-    *ret = swe_difdeg2n(res[0] + args->aspect, args->fixedpt);
+    ret[0] = swe_difdeg2n(res[0] + args->aspect, args->fixedpt);
+    if (args->flags & SEFLG_SPEED)
+        ret[1] = res[3];
     return 0;
 }
 
@@ -283,10 +722,10 @@ int swh_next_aspect(
     const double step = swh_approx_retrotime(planet) || STEP;
     int x = swh_secsearch(jdstart, &_swh_next_aspect, &args,
                           backw ? -step: step, &_swh_next_aspect_step,
-                          stop, 1, jdret, err);
+                          stop, SWH_REFINE_DEFAULT, jdret, err);
     if (!x && posret) {
-        int i = swe_calc_ut(*jdret, planet, flags, posret, err);
-        if (i < 0)
+        SWH_STATS_INC(calc);
+        if (swe_calc_ut(*jdret, planet, flags, posret, err) < 0)
             return 1;
     }
     return x;
@@ -304,261 +743,454 @@ int swh_next_aspect2(
     double* posret,
     char* err)
 {
-    int x1 = 0, x2 = 0;
-    double jd1 = 0, jd2 = 0;
     const double aspnorm = swe_difdeg2n(aspect, 0);
-    const double step = swh_approx_retrotime(planet) || STEP;
     swh_next_aspect_args_t args = {planet, aspnorm,
                                    swe_degnorm(fixedpt), jdstart,
                                    backw, stop, flags,
                                    0, 0};
-
-    x1 = swh_secsearch(jdstart, &_swh_next_aspect, &args,
-                       backw ? -step : step, &_swh_next_aspect_step,
-                       stop, 1, &jd1, err);
-    if (x1 == 1)
-        return 1;
-    if (aspnorm == 0 || aspnorm == -180) {
-        if (!x1) {
-            *jdret = jd1;
-            if (posret) {
-                x1 = swe_calc_ut(jd1, planet, flags, posret, err);
-                if (x1 < 0)
-                    return 1;
-            }
-            return 0;
-        }
-        return 2;
-    }
-    args.aspect = swe_difdeg2n(0, aspect);
-    args.iretro = 0;
-    args.tretro = 0;
-    x2 = swh_secsearch(jdstart, &_swh_next_aspect, &args,
-                       backw ? -step : step, &_swh_next_aspect_step,
-                       stop, 1, &jd2, err);
-    if (x2 == 1)
-        return 1;
-    if (x1 == 2 && x2 == 2)
-        return 2;
-    if (!x1 && !x2) {
-        if (!backw)
-            *jdret = jd1 < jd2 ? jd1 : jd2;
-        else
-            *jdret = jd1 > jd2 ? jd1 : jd2;
-    }
-    else
-        *jdret = !x1 ? jd1 : jd2;
-    if (posret) {
-        x1 = swe_calc_ut(*jdret, planet, flags, posret, err);
-        if (x1 < 0)
+    const double step = swh_approx_retrotime(planet) || STEP;
+    int x = swh_secsearch2(jdstart, &_swh_next_aspect, &args, -2 * aspnorm,
+                           backw ? -step : step, &_swh_next_aspect_step,
+                           stop, SWH_REFINE_DEFAULT, jdret, err);
+    if (!x && posret) {
+        SWH_STATS_INC(calc);
+        if (swe_calc_ut(*jdret, planet, flags, posret, err) < 0)
             return 1;
     }
-    return 0;
+    return x;
 }
 
 typedef struct
 {
-    int planet;
-    double aspect;
-    int other;
-    char* star;
-    int flags;
-    char* starbuf;
-} swh_next_aspect_with_args_t;
+    double lon;     /* longitude of planet at exact aspect */
+    int i;          /* index in fixed points */
+    int found;
+} swh_next_aspect_batch_t;
 
-int _swh_next_aspect_with(double t, void* fargs, double* ret, char* err)
+int _swh_next_aspect_batch_cmp(const void* a, const void* b)
 {
-    int x = 0;
-    swh_next_aspect_with_args_t* args = fargs;
-    double res1[6] = {0,0,0,0,0,0};
-    double res2[6] = {0,0,0,0,0,0};
-
-    x = swe_calc_ut(t, args->planet, args->flags, res1, err);
-    if (x < 0)
-        return x;
-    if (args->star) {
-        if (!args->starbuf) {
-            args->starbuf = malloc((SE_MAX_STNAME*2)+1);
-            if (!args->starbuf) {
-                sprintf(err, "nomem");
-                return 1;
-            }
-            memset(args->starbuf, 0, (SE_MAX_STNAME*2)+1);
-            strncpy(args->starbuf, args->star, SE_MAX_STNAME*2);
-        }
-        x = swe_fixstar2_ut(args->starbuf, t, args->flags, res2, err);
-    }
-    else
-        x = swe_calc_ut(t, args->other, args->flags, res2, err);
-    if (x < 0)
-        return x;
-    *ret = swe_difdeg2n(res1[0] + args->aspect, res2[0]);
-    return 0;
+    const double x = ((const swh_next_aspect_batch_t*) a)->lon;
+    const double y = ((const swh_next_aspect_batch_t*) b)->lon;
+    return x < y ? -1 : x > y ? 1 : 0;
 }
 
-int swh_next_aspect_with(
+int swh_next_aspect_batch(
     int planet,
     double aspect,
-    int other,
-    char* star,
+    const double* fixedpts,
+    int n,
     double jdstart,
     int backw,
     double stop,
     int flags,
-    double* jdret,
-    double* posret1,
-    double* posret2,
+    double* jdrets,
     char* err)
 {
-    swh_next_aspect_with_args_t args = {planet, swe_degnorm(aspect),
-                                        other, star, flags, NULL};
+    swh_next_aspect_args_t args = {planet, swe_degnorm(aspect), 0, jdstart,
+                                   backw, stop, flags, 0, 0};
+    swh_next_aspect_batch_t* targets = NULL;
+    const double step = backw ? -STEP : STEP;
+    double tstop = 0;
+    double t1 = jdstart, t2;
+    double pos1[6] = {0,0,0,0,0,0};
+    double pos2[6] = {0,0,0,0,0,0};
+    int left = n;
+    int i, x = 0;
 
-    int x = swh_secsearch(jdstart, &_swh_next_aspect_with, &args,
-                          backw ? -STEP : STEP, NULL, stop, 1, jdret, err);
-    if (x) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return x;
+    assert(fixedpts);
+    assert(jdrets);
+    assert(err);
+
+    if (n <= 0)
+        return 0;
+    targets = malloc(sizeof(swh_next_aspect_batch_t) * n);
+    if (!targets) {
+        sprintf(err, "nomem");
+        return 1;
     }
-    if (posret1) {
-        x = swe_calc_ut(*jdret, planet, flags, posret1, err);
-        if (x < 0) {
-            if (args.starbuf)
-                free(args.starbuf);
-            return 1;
-        }
+    for (i = 0; i < n; ++i) {
+        targets[i].lon = swe_degnorm(fixedpts[i] - args.aspect);
+        targets[i].i = i;
+        targets[i].found = 0;
+        jdrets[i] = 0;
     }
-    if (posret2) {
-        if (star) {
-            assert(args.starbuf);
-            x = swe_fixstar2_ut(args.starbuf, *jdret, flags, posret2, err);
-            if (x < 0) {
-                free(args.starbuf);
-                return 1;
-            }
+    qsort(targets, n, sizeof(swh_next_aspect_batch_t),
+          &_swh_next_aspect_batch_cmp);
+    if (stop)
+        tstop = backw ? jdstart - fabs(stop) : jdstart + fabs(stop);
+
+    if (swh_cache_calc_ut(t1, planet, flags, pos1, err) < 0) {
+        x = 1;
+        goto end;
+    }
+    while (left) {
+        double lo, span;
+        int lo_i, hi_i, k;
+
+        if (_swh_search_ctx_check(t1, err)) {
+            x = 1;
+            goto end;
         }
-        else {
-            assert(!args.starbuf);
-            x = swe_calc_ut(*jdret, other, flags, posret2, err);
-            if (x < 0)
-                return 1;
+        t2 = t1;
+        memcpy(pos2, pos1, sizeof(double) * 6);
+        /* step as swh_next_aspect, stopping at stations */
+        if (_swh_next_aspect_step(step, &args, &t1, err)) {
+            x = 1;
+            goto end;
+        }
+        if (stop) {
+            if (t2 == tstop) {
+                x = 2;
+                goto end;
+            }
+            if (backw ? t1 < tstop : t1 > tstop)
+                t1 = tstop;
+        }
+        if (swh_cache_calc_ut(t1, planet, flags, pos1, err) < 0) {
+            x = 1;
+            goto end;
+        }
+        /* arc covered by the planet within the step */
+        span = swe_difdeg2n(pos1[0], pos2[0]);
+        lo = span < 0 ? pos1[0] : pos2[0];
+        span = fabs(span);
+        if (span == 0)
+            continue;
+        /* first target in arc */
+        lo_i = 0;
+        hi_i = n;
+        while (lo_i < hi_i) {
+            const int mid = lo_i + ((hi_i - lo_i) / 2);
+            if (targets[mid].lon < lo)
+                lo_i = mid + 1;
+            else
+                hi_i = mid;
+        }
+        for (k = 0; k < n; ++k) {
+            swh_next_aspect_batch_t* tg = &targets[(lo_i + k) % n];
+            double f1[2] = {0, HUGE_VAL};
+            double f2[2] = {0, HUGE_VAL};
+
+            if (swe_degnorm(tg->lon - lo) > span)
+                break;
+            if (tg->found)
+                continue;
+            /* crossed, as in the searches: not at the previous step */
+            f2[0] = swe_difdeg2n(pos2[0] + args.aspect, fixedpts[tg->i]);
+            f1[0] = swe_difdeg2n(pos1[0] + args.aspect, fixedpts[tg->i]);
+            if (f2[0] == 0 || (f1[0] != 0 && f1[0] * f2[0] > 0))
+                continue;
+            if (f1[0] == 0)
+                jdrets[tg->i] = t1;
+            else {
+                if (flags & SEFLG_SPEED) {
+                    f1[1] = pos1[3];
+                    f2[1] = pos2[3];
+                }
+                args.fixedpt = swe_degnorm(fixedpts[tg->i]);
+                if (swh_secsearch_refine(t1, f1, t2, f2, &_swh_next_aspect,
+                                         &args, &jdrets[tg->i], err)) {
+                    x = 1;
+                    goto end;
+                }
+            }
+            tg->found = 1;
+            --left;
         }
     }
-    if (args.starbuf)
-        free(args.starbuf);
-    return 0;
+  end:
+    free(targets);
+    return x;
 }
 
-int swh_next_aspect_with2(
+int swh_return_scan(
     int planet,
-    double aspect,
-    int other,
-    char* star,
+    const double* natal,
+    int n,
+    const double* lats,
+    const double* lons,
+    int hsys,
     double jdstart,
-    int backw,
-    double stop,
+    double jdend,
     int flags,
-    double* jdret,
-    double* posret1,
-    double* posret2,
+    int (*callback)(void* arg, const struct swh_return* ret),
+    void* arg,
     char* err)
 {
-    int x1 = 0, x2 = 0;
-    double jd1 = 0, jd2 = 0;
-    const double aspnorm = swe_difdeg2n(aspect, 0);
-    swh_next_aspect_with_args_t args = {planet, aspnorm, other,
-                                        star, flags, NULL};
-
-    x1 = swh_secsearch(jdstart, &_swh_next_aspect_with, &args,
-                       backw ? -STEP : STEP, NULL, stop, 1, &jd1, err);
-    if (x1 == 1) {
-        if (args.starbuf)
-            free(args.starbuf);
+    swh_next_aspect_args_t args = {planet, 0, 0, jdstart, 0,
+                                   jdend - jdstart, flags | SEFLG_SPEED,
+                                   0, 0};
+    swh_next_aspect_batch_t* targets = NULL;
+    struct swh_return ret;
+    double t1 = jdstart, t2;
+    double pos1[6] = {0,0,0,0,0,0};
+    double pos2[6] = {0,0,0,0,0,0};
+    int i, x = 0;
+
+    assert(natal);
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
         return 1;
     }
-    if (aspnorm == 0 || aspnorm == -180) {
-        if (x1) {
-            assert(x1 == 2);
-            if (args.starbuf)
-                free(args.starbuf);
-            return 2;
+    if (n <= 0)
+        return 0;
+    targets = malloc(sizeof(swh_next_aspect_batch_t) * n);
+    if (!targets) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    for (i = 0; i < n; ++i) {
+        targets[i].lon = swe_degnorm(natal[i]);
+        targets[i].i = i;
+        targets[i].found = 0;
+    }
+    qsort(targets, n, sizeof(swh_next_aspect_batch_t),
+          &_swh_next_aspect_batch_cmp);
+    memset(&ret, 0, sizeof(ret));
+    SWH_STATS_ENTER();
+
+    if (swh_cache_calc_ut(t1, planet, args.flags, pos1, err) < 0) {
+        x = 1;
+        goto end;
+    }
+    while (t1 < jdend) {
+        double lo, span;
+        int lo_i, hi_i, k, cnt;
+
+        if (_swh_search_ctx_check(t1, err)) {
+            x = 1;
+            goto end;
         }
-        *jdret = jd1;
-        if (posret1) {
-            x1 = swe_calc_ut(jd1, planet, flags, posret1, err);
-            if (x1 < 0) {
-                if (args.starbuf)
-                    free(args.starbuf);
-                return 1;
-            }
+        t2 = t1;
+        memcpy(pos2, pos1, sizeof(double) * 6);
+        /* step as swh_next_aspect, stopping at stations */
+        if (_swh_next_aspect_step(STEP, &args, &t1, err)) {
+            x = 1;
+            goto end;
         }
-        if (posret2) {
-            if (star) {
-                assert(args.starbuf);
-                x1 = swe_fixstar2_ut(args.starbuf, jd1, flags, posret2, err);
-                if (x1 < 0) {
-                    free(args.starbuf);
-                    return 1;
+        if (t1 > jdend)
+            t1 = jdend;
+        if (swh_cache_calc_ut(t1, planet, args.flags, pos1, err) < 0) {
+            x = 1;
+            goto end;
+        }
+        /* arc covered by the planet within the step */
+        span = swe_difdeg2n(pos1[0], pos2[0]);
+        lo = span < 0 ? pos1[0] : pos2[0];
+        if (span == 0)
+            continue;
+        /* first target in arc */
+        lo_i = 0;
+        hi_i = n;
+        while (lo_i < hi_i) {
+            const int mid = lo_i + ((hi_i - lo_i) / 2);
+            if (targets[mid].lon < lo)
+                lo_i = mid + 1;
+            else
+                hi_i = mid;
+        }
+        for (cnt = 0; cnt < n; ++cnt) {
+            if (swe_degnorm(targets[(lo_i + cnt) % n].lon - lo) > fabs(span))
+                break;
+        }
+        /* in chronological order, the planet does not station in a step */
+        for (k = 0; k < cnt; ++k) {
+            const swh_next_aspect_batch_t* tg =
+                &targets[(lo_i + (span < 0 ? cnt - 1 - k : k)) % n];
+            double f1[2] = {0, HUGE_VAL};
+            double f2[2] = {0, HUGE_VAL};
+
+            /* crossed, as in the searches: not at the previous step */
+            f2[0] = swe_difdeg2n(pos2[0], tg->lon);
+            f1[0] = swe_difdeg2n(pos1[0], tg->lon);
+            if (f2[0] == 0 || (f1[0] != 0 && f1[0] * f2[0] > 0))
+                continue;
+            if (f1[0] == 0)
+                ret.jd = t1;
+            else {
+                f1[1] = pos1[3];
+                f2[1] = pos2[3];
+                args.fixedpt = tg->lon;
+                if (swh_secsearch_refine(t1, f1, t2, f2, &_swh_next_aspect,
+                                         &args, &ret.jd, err)) {
+                    x = 1;
+                    goto end;
                 }
             }
-            else {
-                assert(!args.starbuf);
-                x1 = swe_calc_ut(jd1, other, flags, posret2, err);
-                if (x1 < 0)
-                    return 1;
+            ret.i = tg->i;
+            if (lats && lons) {
+                SWH_STATS_INC(houses);
+                if (swe_houses_ex(ret.jd, flags, lats[ret.i], lons[ret.i],
+                                  hsys, ret.cusps, ret.ascmc) < 0) {
+                    x = 1;
+                    goto end;
+                }
             }
+            if (callback(arg, &ret))
+                goto end;
         }
-        if (args.starbuf)
-            free(args.starbuf);
-        return 0;
-    }
-    args.aspect = swe_difdeg2n(0, aspect);
-    x2 = swh_secsearch(jdstart, &_swh_next_aspect_with, &args,
-                       backw ? -STEP : STEP, NULL, stop, 1, &jd2, err);
-    if (x2 == 1) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return 1;
     }
-    if (x1 == 2 && x2 == 2) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return 2;
-    }
-    if (!x1 && !x2) {
-        if (!backw)
-            *jdret = jd1 < jd2 ? jd1 : jd2;
-        else
-            *jdret = jd1 > jd2 ? jd1 : jd2;
+  end:
+    SWH_STATS_LEAVE();
+    free(targets);
+    return x;
+}
+
+typedef struct
+{
+    int planet;
+    double aspect;
+    int other;
+    char* star;
+    int flags;
+    double vmax;    /* bound of relative speed, or 0 */
+    double shift;   /* shift to the other side of aspect, or 0 */
+    double last;    /* last value of function */
+    struct swh_star starh; /* initialized on first use */
+} swh_next_aspect_with_args_t;
+
+int _swh_next_aspect_with(double t, void* fargs, double* ret, char* err)
+{
+    int x = 0;
+    swh_next_aspect_with_args_t* args = fargs;
+    double res1[6] = {0,0,0,0,0,0};
+    double res2[6] = {0,0,0,0,0,0};
+
+    x = swh_cache_calc_ut(t, args->planet, args->flags, res1, err);
+    if (x < 0)
+        return x;
+    if (args->star) {
+        if (!args->starh.name[0])
+            swh_star_init(&args->starh, args->star, args->flags);
+        x = swh_star_calc_ut(&args->starh, t, res2, err);
     }
     else
-        *jdret = !x1 ? jd1 : jd2;
+        x = swh_cache_calc_ut(t, args->other, args->flags, res2, err);
+    if (x < 0)
+        return x;
+    ret[0] = swe_difdeg2n(res1[0] + args->aspect, res2[0]);
+    if (args->flags & SEFLG_SPEED)
+        ret[1] = res1[3] - res2[3];
+    args->last = ret[0];
+    return 0;
+}
+
+int _swh_next_aspect_with_step(double step, void* fargs, double* t,
+                               char* err)
+{
+    const swh_next_aspect_with_args_t* args = fargs;
+    const double other = fabs(swe_difdeg2n(args->last + args->shift, 0));
+    /* the aspect can not be reached before that time */
+    const double safe = (args->shift && other < fabs(args->last) ?
+                         other : fabs(args->last)) / args->vmax;
+
+    if (safe > fabs(step))
+        *t += step > 0 ? safe : -safe;
+    else
+        *t += step;
+    return 0;
+}
+
+/* bound of relative speed of two objects, or 0 if unknown */
+double _swh_next_aspect_with_vmax(int planet, int other, const char* star,
+                                  int flags)
+{
+    const double v1 = swh_approx_maxspeed(planet, flags);
+    const double v2 = star ? 0.001 : swh_approx_maxspeed(other, flags);
+    return v1 && v2 ? v1 + v2 : 0;
+}
+
+int swh_next_aspect_with(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    double jdstart,
+    int backw,
+    double stop,
+    int flags,
+    double* jdret,
+    double* posret1,
+    double* posret2,
+    char* err)
+{
+    swh_next_aspect_with_args_t args = {planet, swe_degnorm(aspect),
+                                        other, star, flags,
+                                        _swh_next_aspect_with_vmax(
+                                            planet, other, star, flags),
+                                        0, 0};
+
+    int x = swh_secsearch(jdstart, &_swh_next_aspect_with, &args,
+                          backw ? -STEP : STEP,
+                          args.vmax ? &_swh_next_aspect_with_step : NULL,
+                          stop, SWH_REFINE_DEFAULT, jdret, err);
+    if (x)
+        return x;
     if (posret1) {
-        x1 = swe_calc_ut(*jdret, planet, flags, posret1, err);
-        if (x1 < 0) {
-            if (args.starbuf)
-                free(args.starbuf);
+        SWH_STATS_INC(calc);
+        x = swe_calc_ut(*jdret, planet, flags, posret1, err);
+        if (x < 0)
             return 1;
-        }
     }
     if (posret2) {
-        if (star) {
-            assert(args.starbuf);
-            x1 = swe_fixstar2_ut(args.starbuf, *jdret, flags, posret2, err);
-            if (x1 < 0) {
-                free(args.starbuf);
-                return 1;
-            }
+        if (star)
+            x = swh_star_exact_ut(&args.starh, *jdret, posret2, err);
+        else {
+            SWH_STATS_INC(calc);
+            x = swe_calc_ut(*jdret, other, flags, posret2, err);
         }
+        if (x < 0)
+            return 1;
+    }
+    return 0;
+}
+
+int swh_next_aspect_with2(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    double jdstart,
+    int backw,
+    double stop,
+    int flags,
+    double* jdret,
+    double* posret1,
+    double* posret2,
+    char* err)
+{
+    const double aspnorm = swe_difdeg2n(aspect, 0);
+    swh_next_aspect_with_args_t args = {planet, aspnorm,
+                                        other, star, flags,
+                                        _swh_next_aspect_with_vmax(
+                                            planet, other, star, flags),
+                                        -2 * aspnorm, 0};
+
+    int x = swh_secsearch2(jdstart, &_swh_next_aspect_with, &args,
+                           args.shift, backw ? -STEP : STEP,
+                           args.vmax ? &_swh_next_aspect_with_step : NULL,
+                           stop, SWH_REFINE_DEFAULT, jdret, err);
+    if (x)
+        return x;
+    if (posret1) {
+        SWH_STATS_INC(calc);
+        x = swe_calc_ut(*jdret, planet, flags, posret1, err);
+        if (x < 0)
+            return 1;
+    }
+    if (posret2) {
+        if (star)
+            x = swh_star_exact_ut(&args.starh, *jdret, posret2, err);
         else {
-            assert(!args.starbuf);
-            x1 = swe_calc_ut(*jdret, other, flags, posret2, err);
-            if (x1 < 0)
-                return 1;
+            SWH_STATS_INC(calc);
+            x = swe_calc_ut(*jdret, other, flags, posret2, err);
         }
+        if (x < 0)
+            return 1;
     }
-    if (args.starbuf)
-        free(args.starbuf);
     return 0;
 }
 
@@ -572,42 +1204,161 @@ typedef struct
     double lon;
     int hsys;
     int flags;
-    char* starbuf;
+    struct swh_star starh; /* initialized on first use */
 } swh_next_aspect_cusp_args_t;
 
-int _swh_next_aspect_cusp(double t, void* fargs, double* ret, char* err)
+int _swh_next_aspect_cusp_pos(
+    double t,
+    swh_next_aspect_cusp_args_t* args,
+    double* res,
+    double* cusps,
+    char* err)
 {
     int x = 0;
-    swh_next_aspect_cusp_args_t* args = fargs;
-    double res1[6] = {0,0,0,0,0,0};
-    double res2[37] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-                       0,0,0,0,0,0,0,0,0,0};
     double ascmc[10] = {0,0,0,0,0,0,0,0,0,0};
 
     if (args->star) {
-        if (!args->starbuf) {
-            args->starbuf = malloc((SE_MAX_STNAME*2)+1);
-            if (!args->starbuf) {
-                sprintf(err, "nomem");
-                return 1;
-            }
-            memset(args->starbuf, 0, (SE_MAX_STNAME*2)+1);
-            strncpy(args->starbuf, args->star, SE_MAX_STNAME*2);
-        }
-        x = swe_fixstar2_ut(args->starbuf, t, args->flags, res1, err);
+        if (!args->starh.name[0])
+            swh_star_init(&args->starh, args->star, args->flags);
+        x = swh_star_calc_ut(&args->starh, t, res, err);
     }
     else
-        x = swe_calc_ut(t, args->planet, args->flags, res1, err);
+        x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
     if (x < 0)
         return x;
-    x = swe_houses_ex(t, args->flags, args->lat, args->lon,
-                      args->hsys, res2, ascmc);
+    x = swh_cache_houses_ex(t, args->flags, args->lat, args->lon,
+                            args->hsys, cusps, ascmc);
     if (x < 0)
         return x;
+    return 0;
+}
+
+int _swh_next_aspect_cusp(double t, void* fargs, double* ret, char* err)
+{
+    int x = 0;
+    swh_next_aspect_cusp_args_t* args = fargs;
+    double res1[6] = {0,0,0,0,0,0};
+    double res2[37] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+                       0,0,0,0,0,0,0,0,0,0};
+
+    x = _swh_next_aspect_cusp_pos(t, args, res1, res2, err);
+    if (x)
+        return x;
     *ret = swe_difdeg2n(res1[0] + args->aspect, res2[args->cusp]);
     return 0;
 }
 
+/* mean motion of cusps, degrees per day */
+#define CUSPRATE    (360.98564736629)
+/* max step of cusp searches, in days. Cusps are not uniform (the
+ * ascendant and intermediate cusps go several times faster than the mean
+ * in some signs, at high latitudes), but their motion is always direct and
+ * takes a sidereal day per turn: within a shorter step a cusp can not
+ * travel 360 degrees, and a distance to the contact that grows means the
+ * contact was passed */
+#define CUSPSTEP    (0.45)
+/* max absolute latitude for predicted cusp searches */
+#define CUSPMAXLAT  (60.0)
+#define CUSPMAXITER (200)
+
+/* Tighten the bracket [a;b] of a contact to a cusp, away from
+ * swe_difdeg2n jumps. Returns 0 on success, 1 on error, 2 if iterations
+ * (counted in iter) are exhausted. */
+int _swh_cusp_bracket(
+    swh_next_aspect_cusp_args_t* args,
+    double dir,
+    double* a,
+    double fa[2],
+    double* b,
+    double fb[2],
+    int* iter,
+    char* err)
+{
+    double dista = swe_degnorm(dir * fa[0]);
+
+    while (fabs(fa[0]) > 90 || fabs(fb[0]) > 90) {
+        const double m = (*a + *b) / 2;
+        double fm[2] = {0, HUGE_VAL};
+        double distm;
+        if (++*iter > CUSPMAXITER)
+            return 2;
+        SWH_STATS_INC(evals);
+        if (_swh_next_aspect_cusp(m, args, fm, err))
+            return 1;
+        distm = swe_degnorm(dir * fm[0]);
+        if (distm > dista) {
+            *b = m;
+            fb[0] = fm[0];
+        }
+        else {
+            *a = m;
+            fa[0] = fm[0];
+            dista = distm;
+        }
+    }
+    return 0;
+}
+
+/* Search next aspect to a cusp, predicting the contact from the diurnal
+ * motion of cusps (that is always direct, and way faster than planets).
+ * Returns 0 on success, 1 on error, 2 if the search must be done the
+ * usual way (high latitudes, odd motion of cusps). */
+int _swh_next_aspect_cusp_fast(
+    swh_next_aspect_cusp_args_t* args,
+    double jdstart,
+    int backw,
+    double* jdret,
+    char* err)
+{
+    const double dir = backw ? -1 : 1;
+    double rate = CUSPRATE;
+    double a = jdstart, b = jdstart;
+    double fa[2] = {0, HUGE_VAL};
+    double fb[2] = {0, HUGE_VAL};
+    double dista, distb;
+    int i, x;
+
+    if (fabs(args->lat) > CUSPMAXLAT)
+        return 2;
+    SWH_STATS_INC(evals);
+    if (_swh_next_aspect_cusp(a, args, fa, err))
+        return 1;
+    /* degrees the cusp has still to travel */
+    dista = swe_degnorm(dir * fa[0]);
+    if (dista == 0)
+        dista = 360;
+    for (i = 0; ; ++i) {
+        double dt = ((dista / rate) * 1.1) + PRECISE; /* aim past contact */
+        if (i == CUSPMAXITER)
+            return 2;
+        if (dt > CUSPSTEP)
+            dt = CUSPSTEP;
+        b = a + (dir * dt);
+        fb[0] = 0;
+        SWH_STATS_INC(evals);
+        if (_swh_next_aspect_cusp(b, args, fb, err))
+            return 1;
+        distb = swe_degnorm(dir * fb[0]);
+        if (distb > dista) /* contact passed */
+            break;
+        rate = dista > distb ? (dista - distb) / dt : CUSPRATE;
+        a = b;
+        fa[0] = fb[0];
+        dista = distb;
+    }
+    x = _swh_cusp_bracket(args, dir, &a, fa, &b, fb, &i, err);
+    if (x)
+        return x;
+    if (fa[0] == 0) {
+        *jdret = a;
+        return 0;
+    }
+    if (fa[0] * fb[0] > 0)
+        return 2;
+    return swh_secsearch_refine(b, fb, a, fa, &_swh_next_aspect_cusp, args,
+                                jdret, err);
+}
+
 int swh_next_aspect_cusp(
     int planet,
     char* star,
@@ -627,47 +1378,38 @@ int swh_next_aspect_cusp(
 {
     int x = 0;
     swh_next_aspect_cusp_args_t args = {planet, star, swe_degnorm(aspect),
-                                        cusp, lat, lon, hsys, flags, NULL};
+                                        cusp, lat, lon, hsys, flags};
 
     if (cusp < 1 || cusp > (hsys == 71 ? 36 : 12)) {
         assert(err);
         sprintf(err, "invalid cusp (%d)", cusp);
         return 1;
     }
-    x = swh_secsearch(jdstart, &_swh_next_aspect_cusp, &args,
-                      backw ? -0.05 : 0.05, NULL, 0, 1, jdret, err);
-    if (x) {
-        if (args.starbuf)
-            free(args.starbuf);
+    SWH_STATS_ENTER();
+    x = _swh_next_aspect_cusp_fast(&args, jdstart, backw, jdret, err);
+    SWH_STATS_LEAVE();
+    if (x == 2)
+        x = swh_secsearch(jdstart, &_swh_next_aspect_cusp, &args,
+                          backw ? -0.05 : 0.05, NULL, 0, SWH_REFINE_DEFAULT,
+                          jdret, err);
+    if (x)
         return x;
-    }
     if (posret) {
-        if (star) {
-            assert(args.starbuf);
-            x = swe_fixstar2_ut(args.starbuf, *jdret, flags, posret, err);
-            if (x < 0) {
-                free(args.starbuf);
-                return 1;
-            }
-        }
+        if (star)
+            x = swh_star_exact_ut(&args.starh, *jdret, posret, err);
         else {
-            assert(!args.starbuf);
+            SWH_STATS_INC(calc);
             x = swe_calc_ut(*jdret, planet, flags, posret, err);
-            if (x < 0) {
-                return 1;
-            }
         }
+        if (x < 0)
+            return 1;
     }
     if (cuspsret && ascmcret) {
+        SWH_STATS_INC(houses);
         x = swe_houses_ex(*jdret, flags, lat, lon, hsys, cuspsret, ascmcret);
-        if (x < 0) {
-            if (args.starbuf)
-                free(args.starbuf);
+        if (x < 0)
             return 1;
-        }
     }
-    if (args.starbuf)
-        free(args.starbuf);
     return 0;
 }
 
@@ -688,136 +1430,250 @@ int swh_next_aspect_cusp2(
     double* ascmcret,
     char* err)
 {
-    int x1 = 0, x2 = 0;
+    int x = 0;
     double jd1 = 0, jd2 = 0;
     const double aspnorm = swe_difdeg2n(aspect, 0);
     swh_next_aspect_cusp_args_t args = {planet, star, aspnorm, cusp,
-                                        lat, lon, hsys, flags, NULL};
+                                        lat, lon, hsys, flags};
 
     if (cusp < 1 || cusp > (hsys == 71 ? 36 : 12)) {
         assert(err);
         sprintf(err, "invalid cusp (%d)", cusp);
         return 1;
     }
-    x1 = swh_secsearch(jdstart, &_swh_next_aspect_cusp, &args,
-                       backw ? -0.05 : 0.05, NULL, 0, 1, &jd1, err);
-    if (x1 == 1) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return 1;
+    SWH_STATS_ENTER();
+    x = _swh_next_aspect_cusp_fast(&args, jdstart, backw, &jd1, err);
+    if (!x && aspnorm != 0 && aspnorm != -180) {
+        args.aspect = -aspnorm;
+        x = _swh_next_aspect_cusp_fast(&args, jdstart, backw, &jd2, err);
+        args.aspect = aspnorm;
+        if (!x)
+            jd1 = (jd1 < jd2) != (backw != 0) ? jd1 : jd2;
     }
-    if (aspnorm == 0 || aspnorm == -180) {
-        if (x1 == 2) {
-            if (args.starbuf)
-                free(args.starbuf);
-            return 2;
-        }
-        assert(!x1);
+    SWH_STATS_LEAVE();
+    if (!x)
         *jdret = jd1;
-        if (posret) {
-            if (star) {
-                assert(args.starbuf);
-                x1 = swe_fixstar2_ut(args.starbuf, jd1, flags, posret, err);
-                if (x1 < 0) {
-                    free(args.starbuf);
-                    return 1;
-                }
-            }
-            else {
-                assert(!args.starbuf);
-                x1 = swe_calc_ut(jd1, planet, flags, posret, err);
-                if (x1 < 0)
-                    return 1;
-            }
-        }
-        if (cuspsret && ascmcret) {
-            x1 = swe_houses_ex(jd1, flags, lat, lon, hsys, cuspsret, ascmcret);
-            if (x1 < 0) {
-                if (args.starbuf)
-                    free(args.starbuf);
-                return 1;
-            }
-        }
-        if (args.starbuf)
-            free(args.starbuf);
-        return 0;
-    }
-    args.aspect = swe_difdeg2n(0, aspect);
-    x2 = swh_secsearch(jdstart, &_swh_next_aspect_cusp, &args,
-                       backw ? -0.05 : 0.05, NULL, 0, 1, &jd2, err);
-    if (x2 == 1) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return 1;
-    }
-    if (x1 == 2 && x2 == 2) {
-        if (args.starbuf)
-            free(args.starbuf);
-        return 2;
-    }
-    if (!x1 && !x2) {
-        if (!backw)
-            *jdret = jd1 < jd2 ? jd1 : jd2;
-        else
-            *jdret = jd1 > jd2 ? jd1 : jd2;
-    }
-    else
-        *jdret = !x1 ? jd1 : jd2;
+    else if (x == 2)
+        x = swh_secsearch2(jdstart, &_swh_next_aspect_cusp, &args,
+                           -2 * aspnorm, backw ? -0.05 : 0.05, NULL, 0,
+                           SWH_REFINE_DEFAULT, jdret, err);
+    if (x)
+        return x;
     if (posret) {
-        if (star) {
-            assert(args.starbuf);
-            x1 = swe_fixstar2_ut(args.starbuf, *jdret, flags, posret, err);
-            if (x1 < 0) {
-                free(args.starbuf);
-                return 1;
-            }
-        }
+        if (star)
+            x = swh_star_exact_ut(&args.starh, *jdret, posret, err);
         else {
-            assert(!args.starbuf);
-            x1 = swe_calc_ut(*jdret, planet, flags, posret, err);
-            if (x1 < 0)
-                return 1;
+            SWH_STATS_INC(calc);
+            x = swe_calc_ut(*jdret, planet, flags, posret, err);
         }
+        if (x < 0)
+            return 1;
     }
     if (cuspsret && ascmcret) {
-        x1 = swe_houses_ex(*jdret, flags, lat, lon, hsys, cuspsret, ascmcret);
-        if (x1 < 0) {
-            if (args.starbuf)
-                free(args.starbuf);
+        SWH_STATS_INC(houses);
+        x = swe_houses_ex(*jdret, flags, lat, lon, hsys, cuspsret, ascmcret);
+        if (x < 0)
             return 1;
-        }
     }
-    if (args.starbuf)
-        free(args.starbuf);
     return 0;
 }
 
-int swh_years_diff(
-    double jd1,
-    double jd2,
-    int flags,
-    double* years,
-    char* err)
+/* step of cusp scans beyond CUSPMAXLAT, in days, as swh_next_aspect_cusp;
+ * below, steps aim past the nearest contact predicted from the motion of
+ * cusps, as _swh_next_aspect_cusp_fast */
+#define CUSPSCANSTEP    (0.05)
+
+int swh_aspect_cusp_scan(
+    int planet,
+    char* star,
+    double aspect,
+    double jdstart,
+    double jdend,
+    double lat,
+    double lon,
+    int hsys,
+    int flags,
+    int (*callback)(void* arg, double jd, int cusp),
+    void* arg,
+    char* err)
 {
+    const int ncusps = hsys == 71 ? 36 : 12;
+    const int fast = fabs(lat) <= CUSPMAXLAT;
     double pos1[6] = {0,0,0,0,0,0};
     double pos2[6] = {0,0,0,0,0,0};
-    double dec;
+    double cusps1[37], cusps2[37];
+    double rates[37];
+    double hits[36];
+    int hcusps[36];
+    double t1 = jdstart, t2, dt;
+    int i, j, nhits, x = 0;
+    swh_next_aspect_cusp_args_t args = {planet, star, swe_degnorm(aspect),
+                                        1, lat, lon, hsys, flags};
+
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    memset(cusps1, 0, sizeof(double) * 37);
+    for (i = 0; i < 37; ++i)
+        rates[i] = CUSPRATE;
+    if (_swh_next_aspect_cusp_pos(t1, &args, pos1, cusps1, err)) {
+        x = 1;
+        goto end;
+    }
+    while (t1 < jdend) {
+        if (_swh_search_ctx_check(t1, err)) {
+            x = 1;
+            goto end;
+        }
+        t2 = t1;
+        memcpy(pos2, pos1, sizeof(double) * 6);
+        memcpy(cusps2, cusps1, sizeof(double) * 37);
+        dt = CUSPSCANSTEP;
+        if (fast) { /* aim past the nearest contact */
+            dt = CUSPSTEP;
+            for (i = 1; i <= ncusps; ++i) {
+                const double d = ((swe_degnorm(swe_difdeg2n(
+                    pos2[0] + args.aspect, cusps2[i])) / rates[i]) * 1.1)
+                    + PRECISE;
+                if (d < dt)
+                    dt = d;
+            }
+        }
+        t1 = t2 + dt;
+        if (t1 > jdend)
+            t1 = jdend;
+        if (_swh_next_aspect_cusp_pos(t1, &args, pos1, cusps1, err)) {
+            x = 1;
+            goto end;
+        }
+        nhits = 0;
+        for (i = 1; i <= ncusps; ++i) {
+            double f1[2] = {0, HUGE_VAL};
+            double f2[2] = {0, HUGE_VAL};
+            double a = t2, b = t1;
+            double jd;
+
+            f1[0] = swe_difdeg2n(pos1[0] + args.aspect, cusps1[i]);
+            f2[0] = swe_difdeg2n(pos2[0] + args.aspect, cusps2[i]);
+            if (fast) {
+                /* degrees the cusp has still to travel */
+                const double dist1 = swe_degnorm(f1[0]);
+                const double dist2 = swe_degnorm(f2[0]);
+                if (dist1 < dist2)
+                    rates[i] = (dist2 - dist1) / (t1 - t2);
+                if (f2[0] == 0 || (f1[0] != 0 && dist1 <= dist2))
+                    continue;
+            }
+            else if (fabs(f2[0]) > 90 || f2[0] == 0
+                     || (f1[0] != 0 && f1[0] * f2[0] > 0))
+                continue;
+            if (f1[0] == 0)
+                jd = t1;
+            else {
+                args.cusp = i;
+                if (fast) {
+                    j = 0;
+                    x = _swh_cusp_bracket(&args, 1, &a, f2, &b, f1, &j,
+                                          err);
+                    if (x == 2)
+                        sprintf(err, "unable to bracket cusp %d (%.8f)",
+                                i, t2);
+                    if (x) {
+                        x = 1;
+                        goto end;
+                    }
+                }
+                if (f2[0] == 0)
+                    jd = a;
+                else if (f1[0] == 0)
+                    jd = b;
+                else if (swh_secsearch_refine(b, f1, a, f2,
+                                              &_swh_next_aspect_cusp, &args,
+                                              &jd, err)) {
+                    x = 1;
+                    goto end;
+                }
+            }
+            /* keep hits in chronological order */
+            for (j = nhits; j > 0 && hits[j-1] > jd; --j) {
+                hits[j] = hits[j-1];
+                hcusps[j] = hcusps[j-1];
+            }
+            hits[j] = jd;
+            hcusps[j] = i;
+            ++nhits;
+        }
+        for (i = 0; i < nhits; ++i) {
+            if ((*callback)(arg, hits[i], hcusps[i]))
+                goto end;
+        }
+    }
+  end:
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+/* mean tropical year, in days */
+#define TROPYEAR    (365.24219)
+/* mean sidereal year, in days */
+#define SIDYEAR     (365.256363)
+/* max distance of a solar return to its mean estimate, in days */
+#define YEARMARGIN  (10.0)
+/* spans (in days) above which returns are counted one by one */
+#define YEARMAXSPAN (2000*TROPYEAR)
+
+int swh_years_diff(
+    double jd1,
+    double jd2,
+    int flags,
+    double* years,
+    char* err)
+{
+    double pos1[6] = {0,0,0,0,0,0};
+    double pos2[6] = {0,0,0,0,0,0};
+    double dec, jd;
     const double inch = INCH;
-    int x;
+    const double year = (flags & SEFLG_SIDEREAL) ? SIDYEAR : TROPYEAR;
+    int k, x;
 
     assert(years);
     assert(err);
 
+    SWH_STATS_INC(calc);
     x = swe_calc_ut(jd1, SE_SUN, flags, pos1, err);
     if (x < 0)
         return x;
+    SWH_STATS_INC(calc);
     x = swe_calc_ut(jd2, SE_SUN, flags, pos2, err);
     if (x < 0)
         return x;
     *years = 0;
 
+    /* Estimate the number of returns with the mean year, and search the
+     * last one only. Returns stay within a few hours of their estimate
+     * for spans of centuries, far below the margin. */
+    k = fabs(jd2 - jd1) < YEARMAXSPAN ? (int) (fabs(jd2 - jd1) / year) : 0;
+
     if (jd1 < jd2) { /* forward search */
         dec = swe_difdegn(pos2[0], pos1[0]) / 360.0;
+        if (k > 1) {
+            x = swh_next_aspect(SE_SUN, 0, pos1[0],
+                                jd1 + (k * year) - YEARMARGIN, 0, 0,
+                                flags, &jd, NULL, err);
+            if (x)
+                return x;
+            if (jd+inch > jd2) {
+                *years = k - 1 + dec;
+                return 0;
+            }
+            *years = k;
+            jd1 = jd;
+        }
         for (;;) {
             x = swh_next_aspect(SE_SUN, 0, pos1[0], jd1+inch, 0, 0,
                                 flags, &jd1, NULL, err);
@@ -832,6 +1688,19 @@ int swh_years_diff(
     }
     else if (jd1 > jd2) { /* backwards search */
         dec = swe_difdegn(pos1[0], pos2[0]) / 360.0;
+        if (k > 1) {
+            x = swh_next_aspect(SE_SUN, 0, pos1[0],
+                                jd1 - (k * year) + YEARMARGIN, 1, 0,
+                                flags, &jd, NULL, err);
+            if (x)
+                return x;
+            if (jd-inch <= jd2) {
+                *years = -(k - 1) - dec;
+                return 0;
+            }
+            *years = -k;
+            jd1 = jd;
+        }
         for (;;) {
             x = swh_next_aspect(SE_SUN, 0, pos1[0], jd1-inch, 1, 0,
                                 flags, &jd1, NULL, err);
@@ -848,4 +1717,864 @@ int swh_years_diff(
     return 0;
 }
 
+typedef struct
+{
+    int i1;         /* index of planet in bodies */
+    int i2;         /* index of other in bodies */
+    int iaspect;
+    double aspect;
+} swh_aspect_scan_target_t;
+
+int _swh_aspect_scan_index(int* bodies, int* nbodies, int planet)
+{
+    int i;
+    for (i = 0; i < *nbodies; ++i) {
+        if (bodies[i] == planet)
+            return i;
+    }
+    bodies[(*nbodies)++] = planet;
+    return i;
+}
+
+int swh_aspect_scan(
+    const int* planets,
+    int nplanets,
+    const int* others,
+    int nothers,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_aspect_hit* hit),
+    void* arg,
+    char* err)
+{
+    int* bodies = NULL;
+    int nbodies = 0;
+    swh_aspect_scan_target_t* targets = NULL;
+    int ntargets = 0;
+    double* pos1 = NULL; /* positions at previous step */
+    double* pos2 = NULL; /* positions at current step */
+    struct swh_events hits = SWH_EVENTS_INIT(struct swh_aspect_hit);
+    double t1, t2;
+    unsigned int istep = 0;
+    int i, j, k, x = 0;
+
+    assert(planets);
+    assert(others);
+    assert(aspects);
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    bodies = malloc(sizeof(int) * (nplanets + nothers + 1));
+    targets = malloc(sizeof(swh_aspect_scan_target_t)
+                     * ((nplanets * nothers * naspects * 2) + 1));
+    if (!bodies || !targets) {
+        sprintf(err, "nomem");
+        x = 1;
+        goto end;
+    }
+    /* list distinct bodies and targets */
+    for (i = 0; i < nplanets; ++i) {
+        for (j = 0; j < nothers; ++j) {
+            int dupl = 0;
+            const int i1 = _swh_aspect_scan_index(bodies, &nbodies,
+                                                  planets[i]);
+            const int i2 = _swh_aspect_scan_index(bodies, &nbodies,
+                                                  others[j]);
+            if (i1 == i2)
+                continue;
+            for (k = 0; k < ntargets; ++k) {
+                if ((targets[k].i1 == i1 && targets[k].i2 == i2)
+                    || (targets[k].i1 == i2 && targets[k].i2 == i1)) {
+                    dupl = 1;
+                    break;
+                }
+            }
+            if (dupl)
+                continue;
+            for (k = 0; k < naspects; ++k) {
+                const double aspnorm = swe_difdeg2n(aspects[k], 0);
+                swh_aspect_scan_target_t* tg = &targets[ntargets++];
+                tg->i1 = i1;
+                tg->i2 = i2;
+                tg->iaspect = k;
+                tg->aspect = swe_degnorm(aspnorm);
+                if (aspnorm == 0 || aspnorm == -180)
+                    continue;
+                tg = &targets[ntargets++];
+                tg->i1 = i1;
+                tg->i2 = i2;
+                tg->iaspect = k;
+                tg->aspect = swe_degnorm(swe_difdeg2n(0, aspects[k]));
+            }
+        }
+    }
+    pos1 = malloc(sizeof(double) * 6 * (nbodies + 1));
+    pos2 = malloc(sizeof(double) * 6 * (nbodies + 1));
+    if (!pos1 || !pos2) {
+        sprintf(err, "nomem");
+        x = 1;
+        goto end;
+    }
+    /* step through time range */
+    t2 = jdstart;
+    for (i = 0; i < nbodies; ++i) {
+        if (swh_cache_calc_ut(t2, bodies[i], flags, &pos2[i*6], err) < 0) {
+            x = 1;
+            goto end;
+        }
+    }
+    while (t2 < jdend) {
+        double* p = pos1;
+        if (_swh_search_ctx_check(t2, err)) {
+            x = 1;
+            goto end;
+        }
+        pos1 = pos2;
+        pos2 = p;
+        t1 = t2;
+        t2 = jdstart + (++istep * STEP);
+        if (t2 > jdend)
+            t2 = jdend;
+        for (i = 0; i < nbodies; ++i) {
+            if (swh_cache_calc_ut(t2, bodies[i], flags, &pos2[i*6], err) < 0) {
+                x = 1;
+                goto end;
+            }
+        }
+        hits.n = 0;
+        for (k = 0; k < ntargets; ++k) {
+            const swh_aspect_scan_target_t* tg = &targets[k];
+            double f1[2], f2[2];
+            swh_next_aspect_with_args_t args;
+            struct swh_aspect_hit* h;
+
+            f1[0] = swe_difdeg2n(pos1[(tg->i1*6)] + tg->aspect,
+                                 pos1[(tg->i2*6)]);
+            f2[0] = swe_difdeg2n(pos2[(tg->i1*6)] + tg->aspect,
+                                 pos2[(tg->i2*6)]);
+            if (fabs(f1[0]) > 90 || f1[0] == 0
+                || (f2[0] != 0 && f1[0] * f2[0] > 0))
+                continue;
+            h = _swh_events_add(&hits, err);
+            if (!h) {
+                x = 1;
+                goto end;
+            }
+            h->planet = bodies[tg->i1];
+            h->other = bodies[tg->i2];
+            h->iaspect = tg->iaspect;
+            h->aspect = tg->aspect;
+            if (f2[0] == 0) {
+                h->jd = t2;
+                continue;
+            }
+            if (flags & SEFLG_SPEED) {
+                f1[1] = pos1[(tg->i1*6)+3] - pos1[(tg->i2*6)+3];
+                f2[1] = pos2[(tg->i1*6)+3] - pos2[(tg->i2*6)+3];
+            }
+            else
+                f1[1] = f2[1] = HUGE_VAL;
+            memset(&args, 0, sizeof(args));
+            args.planet = bodies[tg->i1];
+            args.aspect = tg->aspect;
+            args.other = bodies[tg->i2];
+            args.star = NULL;
+            args.flags = flags;
+            if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_next_aspect_with,
+                                     &args, &h->jd, err)) {
+                x = 1;
+                goto end;
+            }
+        }
+        _swh_events_sort(&hits);
+        for (i = 0; i < hits.n; ++i) {
+            if ((*callback)(arg, _swh_events_get(&hits, i)))
+                goto end;
+        }
+    }
+  end:
+    SWH_STATS_LEAVE();
+    if (bodies)
+        free(bodies);
+    if (targets)
+        free(targets);
+    if (pos1)
+        free(pos1);
+    if (pos2)
+        free(pos2);
+    _swh_events_free(&hits);
+    return x;
+}
+
+typedef struct
+{
+    swh_next_aspect_with_args_t* with;
+    double orb;     /* orb crossed, or negative for relative speed */
+} swh_aspect_orb_args_t;
+
+/* distance to orb, or relative speed */
+int _swh_aspect_orb(double t, void* fargs, double* ret, char* err)
+{
+    const swh_aspect_orb_args_t* args = fargs;
+    double fv[2] = {0, 0};
+
+    if (_swh_next_aspect_with(t, args->with, fv, err))
+        return 1;
+    if (args->orb < 0) {
+        ret[0] = fv[1];
+        return 0;
+    }
+    ret[0] = fabs(fv[0]) - args->orb;
+    ret[1] = fv[0] < 0 ? -fv[1] : fv[1];
+    return 0;
+}
+
+/* if within orb, with orbs of swh_match_aspect3 */
+int _swh_aspect_orb_in(const double* f, const double* orbs)
+{
+    const double v = f[0] < 0 ? -f[1] : f[1];
+    return fabs(f[0]) <= (v < 0 ? orbs[0] : v > 0 ? orbs[1] : orbs[2]);
+}
+
+int swh_aspect_orb_scan(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    double app_orb,
+    double sep_orb,
+    double def_orb,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_aspect_orb* orb),
+    void* arg,
+    char* err)
+{
+    const double orbs[3] = {fabs(app_orb), fabs(sep_orb), fabs(def_orb)};
+    swh_next_aspect_with_args_t with = {planet, swe_degnorm(aspect),
+                                        other, star, flags | SEFLG_SPEED,
+                                        0, 0, 0};
+    swh_aspect_orb_args_t oargs[3] = {{&with, orbs[0]}, {&with, orbs[1]},
+                                      {&with, -1}};
+    struct swh_aspect_orb cur;
+    double f1[2] = {0, 0};
+    double f2[2] = {0, 0};
+    double evt[4];  /* events of a step, in chronological order */
+    int kind[4];    /* exact [-1], or index in oargs */
+    double t1, t2 = jdstart;
+    double step = STEP, minorb, vmax;
+    unsigned int istep = 0;
+    int i, j, k, n, in, open, x = 0;
+
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    SWH_STATS_ENTER();
+    /* an orb can not be crossed twice within a step */
+    vmax = _swh_next_aspect_with_vmax(planet, other, star, flags);
+    minorb = orbs[0] && (!orbs[1] || orbs[0] < orbs[1]) ? orbs[0] : orbs[1];
+    if (vmax && minorb && minorb / vmax < step)
+        step = minorb / vmax;
+
+    memset(&cur, 0, sizeof(cur));
+    if (_swh_next_aspect_with(t2, &with, f2, err)) {
+        x = 1;
+        goto end;
+    }
+    open = _swh_aspect_orb_in(f2, orbs);
+    if (open)
+        cur.jdin = jdstart;
+    while (t2 < jdend) {
+        if (_swh_search_ctx_check(t2, err)) {
+            x = 1;
+            goto end;
+        }
+        t1 = t2;
+        f1[0] = f2[0];
+        f1[1] = f2[1];
+        t2 = jdstart + (++istep * step);
+        if (t2 > jdend)
+            t2 = jdend;
+        if (_swh_next_aspect_with(t2, &with, f2, err)) {
+            x = 1;
+            goto end;
+        }
+        /* exact aspect, and crossings of orbs or of relative speed */
+        n = 0;
+        for (k = -1; k < 3; ++k) {
+            double g1[2] = {0, HUGE_VAL};
+            double g2[2] = {0, HUGE_VAL};
+            double jd;
+
+            if (k == -1) {
+                if (fabs(f1[0]) > 90 || f1[0] == 0
+                    || (f2[0] != 0 && f1[0] * f2[0] > 0))
+                    continue;
+                if (f2[0] == 0)
+                    jd = t2;
+                else if (swh_secsearch_refine(t2, f2, t1, f1,
+                                              &_swh_next_aspect_with, &with,
+                                              &jd, err)) {
+                    x = 1;
+                    goto end;
+                }
+            }
+            else {
+                if (k == 1 && orbs[1] == orbs[0])
+                    continue;
+                if (k == 2) {
+                    g1[0] = f1[1];
+                    g2[0] = f2[1];
+                    if ((g1[0] < 0) == (g2[0] < 0))
+                        continue;
+                }
+                else {
+                    g1[0] = fabs(f1[0]) - orbs[k];
+                    g1[1] = f1[0] < 0 ? -f1[1] : f1[1];
+                    g2[0] = fabs(f2[0]) - orbs[k];
+                    g2[1] = f2[0] < 0 ? -f2[1] : f2[1];
+                    if ((g1[0] <= 0) == (g2[0] <= 0))
+                        continue;
+                }
+                if (g1[0] == 0)
+                    jd = t1;
+                else if (g2[0] == 0)
+                    jd = t2;
+                else if (swh_secsearch_refine(t2, g2, t1, g1,
+                                              &_swh_aspect_orb, &oargs[k],
+                                              &jd, err)) {
+                    x = 1;
+                    goto end;
+                }
+            }
+            for (j = n; j > 0 && evt[j-1] > jd; --j) {
+                evt[j] = evt[j-1];
+                kind[j] = kind[j-1];
+            }
+            evt[j] = jd;
+            kind[j] = k;
+            ++n;
+        }
+        if (!n) {
+            /* crossings missed within the step (should not happen) */
+            if (open == _swh_aspect_orb_in(f2, orbs))
+                continue;
+            evt[0] = t2;
+            kind[0] = 0;
+            n = 1;
+        }
+        for (i = 0; i < n; ++i) {
+            if (kind[i] == -1) {
+                if (!open) {
+                    cur.jdin = evt[i];
+                    open = 1;
+                }
+                if (cur.nexact < SWH_ORB_MAXEXACT)
+                    cur.exact[cur.nexact] = evt[i];
+                ++cur.nexact;
+            }
+            /* state up to next event */
+            if (i == n - 1)
+                in = _swh_aspect_orb_in(f2, orbs);
+            else {
+                double fm[2] = {0, 0};
+                if (_swh_next_aspect_with((evt[i] + evt[i+1]) / 2, &with,
+                                          fm, err)) {
+                    x = 1;
+                    goto end;
+                }
+                in = _swh_aspect_orb_in(fm, orbs);
+            }
+            if (open && !in) {
+                cur.jdout = evt[i];
+                open = 0;
+                if ((*callback)(arg, &cur))
+                    goto end;
+                memset(&cur, 0, sizeof(cur));
+            }
+            else if (!open && in) {
+                cur.jdin = evt[i];
+                open = 1;
+            }
+        }
+    }
+    if (open) {
+        cur.jdout = jdend;
+        (*callback)(arg, &cur);
+    }
+  end:
+    SWH_STATS_LEAVE();
+    return x;
+}
+
+typedef struct
+{
+    const struct swh_search_target* tg;
+    int flags;
+} swh_next_target_args_t;
+
+/* value of the target kind at t, with its derivative if known */
+int _swh_next_target(double t, void* fargs, double* ret, char* err)
+{
+    const swh_next_target_args_t* args = fargs;
+    const struct swh_search_target* tg = args->tg;
+    const int i = tg->coord;
+    double res1[6] = {0,0,0,0,0,0};
+    double res2[6] = {0,0,0,0,0,0};
+    double v, dv;
+
+    int x = swh_cache_calc_ut(t, tg->planet, args->flags, res1, err);
+    if (x < 0)
+        return x;
+    v = res1[i];
+    dv = i < 3 ? res1[i+3] : 0;
+    if (tg->kind != SWH_TARGET_VALUE) {
+        const double sign = tg->kind == SWH_TARGET_DIFF ? -1 : 1;
+        x = swh_cache_calc_ut(t, tg->other, args->flags, res2, err);
+        if (x < 0)
+            return x;
+        v += sign * res2[i];
+        dv += i < 3 ? sign * res2[i+3] : 0;
+    }
+    ret[0] = tg->wrap ? swe_difdeg2n(v, tg->value) : v - tg->value;
+    /* speeds are known for positions only */
+    if (i < 3 && (args->flags & SEFLG_SPEED))
+        ret[1] = dv;
+    return 0;
+}
+
+int swh_next_target(
+    const struct swh_search_target* tg,
+    double jdstart,
+    int backw,
+    double stop,
+    double* jdret,
+    char* err)
+{
+    swh_next_target_args_t args;
+
+    assert(tg);
+    assert(jdret);
+    assert(err);
+
+    if (tg->coord < 0 || tg->coord > 5
+        || tg->kind < SWH_TARGET_VALUE || tg->kind > SWH_TARGET_SUM
+        || (tg->kind != SWH_TARGET_VALUE && tg->other == tg->planet)) {
+        sprintf(err, "invalid argument");
+        return 3;
+    }
+    args.tg = tg;
+    args.flags = tg->equatorial ? tg->flags | SEFLG_EQUATORIAL
+        : tg->flags & ~SEFLG_EQUATORIAL;
+    /* speeds are zero without the flag */
+    if (tg->coord > 2)
+        args.flags |= SEFLG_SPEED;
+    return swh_secsearch(jdstart, &_swh_next_target, &args,
+                         backw ? -STEP : STEP, NULL, stop,
+                         SWH_REFINE_DEFAULT, jdret, err);
+}
+
+#define CURSOR_RETRO        0
+#define CURSOR_ASPECT       1
+#define CURSOR_ASPECT_WITH  2
+
+struct swh_cursor
+{
+    int type;
+    int both;       /* search both sides of aspect */
+    double jd;      /* current position */
+    int found;      /* if current position is an event */
+    int backw;      /* direction of last search */
+    swh_next_aspect_args_t asp;
+    swh_next_aspect_with_args_t with;
+};
+
+struct swh_cursor* _swh_cursor_new(int type, double jdstart, char* err)
+{
+    struct swh_cursor* cur = malloc(sizeof(struct swh_cursor));
+    if (!cur) {
+        sprintf(err, "nomem");
+        return NULL;
+    }
+    memset(cur, 0, sizeof(struct swh_cursor));
+    cur->type = type;
+    cur->jd = jdstart;
+    return cur;
+}
+
+struct swh_cursor* swh_cursor_new_retro(
+    int planet,
+    double jdstart,
+    int flags,
+    char* err)
+{
+    struct swh_cursor* cur;
+
+    assert(err);
+
+    if (!swh_next_retro_possible(planet, flags)) {
+        sprintf(err, "invalid argument");
+        return NULL;
+    }
+    cur = _swh_cursor_new(CURSOR_RETRO, jdstart, err);
+    if (!cur)
+        return NULL;
+    cur->asp.planet = planet;
+    cur->asp.flags = flags;
+    return cur;
+}
+
+struct swh_cursor* swh_cursor_new_aspect(
+    int planet,
+    double aspect,
+    double fixedpt,
+    int both,
+    double jdstart,
+    int flags,
+    char* err)
+{
+    struct swh_cursor* cur;
+
+    assert(err);
+
+    cur = _swh_cursor_new(CURSOR_ASPECT, jdstart, err);
+    if (!cur)
+        return NULL;
+    cur->both = both ? 1 : 0;
+    cur->asp.planet = planet;
+    cur->asp.aspect = both ? swe_difdeg2n(aspect, 0) : swe_degnorm(aspect);
+    cur->asp.fixedpt = swe_degnorm(fixedpt);
+    cur->asp.flags = flags;
+    return cur;
+}
+
+struct swh_cursor* swh_cursor_new_aspect_with(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    int both,
+    double jdstart,
+    int flags,
+    char* err)
+{
+    struct swh_cursor* cur;
+
+    assert(err);
+
+    cur = _swh_cursor_new(CURSOR_ASPECT_WITH, jdstart, err);
+    if (!cur)
+        return NULL;
+    cur->both = both ? 1 : 0;
+    cur->with.planet = planet;
+    cur->with.aspect = both ? swe_difdeg2n(aspect, 0) : swe_degnorm(aspect);
+    cur->with.other = other;
+    cur->with.star = star;
+    cur->with.flags = flags;
+    cur->with.vmax = _swh_next_aspect_with_vmax(planet, other, star, flags);
+    cur->with.shift = both ? -2 * cur->with.aspect : 0;
+    return cur;
+}
+
+int _swh_cursor_search(
+    struct swh_cursor* cur,
+    int backw,
+    double stop,
+    double* jdret,
+    double* posret,
+    char* err)
+{
+    /* step over the current event */
+    const double start = !cur->found ? cur->jd :
+        backw ? cur->jd - INCH : cur->jd + INCH;
+    double jd = 0;
+    int x = 0;
+
+    switch (cur->type) {
+    case CURSOR_RETRO:
+        x = swh_next_retro(cur->asp.planet, start, backw, stop,
+                           cur->asp.flags, &jd, NULL, err);
+        break;
+    case CURSOR_ASPECT: {
+        swh_next_aspect_args_t* args = &cur->asp;
+        const double step = swh_approx_retrotime(args->planet) || STEP;
+        /* keep the next station known, if still ahead; no station found
+           may only mean beyond the previous limit, unless it never
+           stations */
+        if (backw != cur->backw
+            || (args->iretro == -1
+                && swh_next_retro_possible(args->planet, args->flags))
+            || (args->iretro == 1
+                && (backw ? start <= args->tretro
+                    : start >= args->tretro))) {
+            args->iretro = 0;
+            args->tretro = 0;
+        }
+        args->jdstart = start;
+        args->backw = backw;
+        args->stop = stop;
+        if (cur->both)
+            x = swh_secsearch2(start, &_swh_next_aspect, args,
+                               -2 * args->aspect, backw ? -step : step,
+                               &_swh_next_aspect_step, stop,
+                               SWH_REFINE_DEFAULT, &jd, err);
+        else
+            x = swh_secsearch(start, &_swh_next_aspect, args,
+                              backw ? -step : step, &_swh_next_aspect_step,
+                              stop, SWH_REFINE_DEFAULT, &jd, err);
+        if (x == 2) {
+            args->iretro = 0;
+            args->tretro = 0;
+        }
+        break;
+    }
+    case CURSOR_ASPECT_WITH: {
+        swh_next_aspect_with_args_t* args = &cur->with;
+        int (*nextep)(double, void*, double*, char*) = args->vmax ?
+            &_swh_next_aspect_with_step : NULL;
+        if (cur->both)
+            x = swh_secsearch2(start, &_swh_next_aspect_with, args,
+                               args->shift, backw ? -STEP : STEP, nextep,
+                               stop, SWH_REFINE_DEFAULT, &jd, err);
+        else
+            x = swh_secsearch(start, &_swh_next_aspect_with, args,
+                              backw ? -STEP : STEP, nextep, stop,
+                              SWH_REFINE_DEFAULT, &jd, err);
+        break;
+    }
+    default:
+        assert(0);
+    }
+    cur->backw = backw;
+    if (x)
+        return x;
+    cur->jd = jd;
+    cur->found = 1;
+    *jdret = jd;
+    if (posret) {
+        const int planet = cur->type == CURSOR_ASPECT_WITH ?
+            cur->with.planet : cur->asp.planet;
+        const int flags = cur->type == CURSOR_ASPECT_WITH ?
+            cur->with.flags : cur->asp.flags;
+        SWH_STATS_INC(calc);
+        if (swe_calc_ut(jd, planet, flags, posret, err) < 0)
+            return 1;
+    }
+    return 0;
+}
+
+int swh_cursor_next(
+    struct swh_cursor* cur,
+    double stop,
+    double* jdret,
+    double* posret,
+    char* err)
+{
+    assert(cur);
+    assert(jdret);
+    assert(err);
+    return _swh_cursor_search(cur, 0, stop, jdret, posret, err);
+}
+
+int swh_cursor_prev(
+    struct swh_cursor* cur,
+    double stop,
+    double* jdret,
+    double* posret,
+    char* err)
+{
+    assert(cur);
+    assert(jdret);
+    assert(err);
+    return _swh_cursor_search(cur, 1, stop, jdret, posret, err);
+}
+
+void swh_cursor_free(struct swh_cursor* cur)
+{
+    if (!cur)
+        return;
+    free(cur);
+}
+
+void* _swh_events_add(struct swh_events* ev, char* err)
+{
+    assert(ev);
+
+    if (ev->n == ev->max) {
+        void* p = realloc(ev->v, ev->size * (ev->max + 256));
+        void* q;
+        if (!p) {
+            sprintf(err, "nomem");
+            return NULL;
+        }
+        ev->v = p;
+        q = realloc(ev->keys, sizeof(struct swh_events_key)
+                    * (ev->max + 256));
+        if (!q) {
+            sprintf(err, "nomem");
+            return NULL;
+        }
+        ev->keys = q;
+        ev->max += 256;
+    }
+    memset(ev->v + (ev->size * ev->n), 0, ev->size);
+    return ev->v + (ev->size * ev->n++);
+}
+
+int _swh_events_cmp(const void* a, const void* b)
+{
+    const struct swh_events_key* x = a;
+    const struct swh_events_key* y = b;
+    if (x->jd != y->jd)
+        return x->jd < y->jd ? -1 : 1;
+    return x->i < y->i ? -1 : x->i > y->i ? 1 : 0;
+}
+
+void _swh_events_sort(struct swh_events* ev)
+{
+    int i;
+
+    assert(ev);
+
+    for (i = 0; i < ev->n; ++i) {
+        ev->keys[i].jd = *(const double*)
+            (ev->v + (ev->size * i) + ev->jdoff);
+        ev->keys[i].i = i;
+    }
+    qsort(ev->keys, ev->n, sizeof(struct swh_events_key), &_swh_events_cmp);
+}
+
+void* _swh_events_get(const struct swh_events* ev, int k)
+{
+    assert(ev);
+    assert(k >= 0 && k < ev->n);
+
+    return ev->v + (ev->size * ev->keys[k].i);
+}
+
+void _swh_events_free(struct swh_events* ev)
+{
+    if (!ev)
+        return;
+    if (ev->v)
+        free(ev->v);
+    if (ev->keys)
+        free(ev->keys);
+    ev->v = NULL;
+    ev->keys = NULL;
+    ev->n = ev->max = 0;
+}
+
+typedef struct
+{
+    int (*pos)(void* arg, int i, double t, double* ret, char* err);
+    void* arg;
+    int i;
+} swh_path_walk_args_t;
+
+/* speed along a path */
+int _swh_path_walk_speed(double t, void* fargs, double* ret, char* err)
+{
+    const swh_path_walk_args_t* args = fargs;
+    double p[2] = {0, 0};
+
+    if ((*args->pos)(args->arg, args->i, t, p, err))
+        return 1;
+    ret[0] = p[1];
+    return 0;
+}
+
+int _swh_path_walk(
+    int npaths,
+    double jdstart,
+    double jdend,
+    double step,
+    int (*pos)(void* arg, int i, double t, double* ret, char* err),
+    int (*segment)(void* arg, int i, double t1, const double* p1,
+                   double t2, const double* p2, char* err),
+    int (*done)(void* arg, char* err),
+    void* arg,
+    char* err)
+{
+    double* p = NULL; /* positions at start and end of steps */
+    double t1, t2 = jdstart;
+    unsigned int istep = 0;
+    int i, x = 0;
+
+    assert(pos);
+    assert(segment);
+    assert(step > 0);
+
+    p = malloc(sizeof(double) * 4 * (npaths + 1));
+    if (!p) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    for (i = 0; i < npaths; ++i) {
+        if ((*pos)(arg, i, t2, &p[(i*4)+2], err)) {
+            x = 1;
+            goto end;
+        }
+    }
+    while (t2 < jdend) {
+        if (_swh_search_ctx_check(t2, err)) {
+            x = 1;
+            goto end;
+        }
+        t1 = t2;
+        t2 = jdstart + (++istep * step);
+        if (t2 > jdend)
+            t2 = jdend;
+        for (i = 0; i < npaths; ++i) {
+            double* p1 = &p[i*4];
+            double* p2 = &p[(i*4)+2];
+            p1[0] = p2[0];
+            p1[1] = p2[1];
+            if ((*pos)(arg, i, t2, p2, err)) {
+                x = 1;
+                goto end;
+            }
+            /* split the step at a station */
+            if (p1[1] != 0 && p2[1] != 0 && (p1[1] < 0) != (p2[1] < 0)) {
+                swh_path_walk_args_t args = {pos, arg, i};
+                double f1[2] = {p1[1], HUGE_VAL};
+                double f2[2] = {p2[1], HUGE_VAL};
+                double ts, ps[2] = {0, 0};
+                if (swh_secsearch_refine(t2, f2, t1, f1,
+                                         &_swh_path_walk_speed, &args, &ts,
+                                         err)
+                    || (*pos)(arg, i, ts, ps, err)) {
+                    x = 1;
+                    goto end;
+                }
+                x = (*segment)(arg, i, t1, p1, ts, ps, err);
+                if (!x)
+                    x = (*segment)(arg, i, ts, ps, t2, p2, err);
+            }
+            else
+                x = (*segment)(arg, i, t1, p1, t2, p2, err);
+            if (x)
+                goto end;
+        }
+        if (done && (x = (*done)(arg, err)))
+            goto end;
+    }
+  end:
+    free(p);
+    return x;
+}
+
 /* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
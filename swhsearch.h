@@ -20,11 +20,126 @@
 #ifndef SWHSEARCH_H
 #define SWHSEARCH_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/* Refinement methods for swh_secsearch */
+#define SWH_REFINE_NONE     0 /* linear interpolation of first bracket */
+#define SWH_REFINE_BISECT   1 /* recursive halving of the step */
+#define SWH_REFINE_NEWTON   2 /* safeguarded Newton, Illinois fallback */
+
+/** @brief Refinement method used by the swh_next_* functions */
+#ifndef SWH_REFINE_DEFAULT
+#define SWH_REFINE_DEFAULT  SWH_REFINE_NEWTON
+#endif
+
+/** @brief Generic search of a function root
+ *
+ * Step through time from t1 until the function f changes sign, then refine
+ * the root found in that last step.
+ *
+ * The function f receives a time, the fargs argument, a buffer for returned
+ * values declared as double[2], and the buffer for errors. It must return 0
+ * on success. The value of the function goes in ret[0]. Optionally, its
+ * derivative (per day) can be returned in ret[1], which is otherwise left
+ * to HUGE_VAL.
+ *
+ * With SWH_REFINE_NEWTON, the root is refined with Newton steps when the
+ * derivative is known, and regula falsi (Illinois) steps otherwise, always
+ * kept within the bracket.
+ *
+ * If interpolation is enabled, the root is finally corrected with exact
+ * positions (see swh_cheby_enable).
+ *
+ * @remarks Sign changes where the previous value exceeds 90 are ignored,
+ * to skip the jumps of swe_difdeg2n.
+ *
+ * @param t1 Julian day number, when search is starting
+ * @param f Function searched
+ * @param fargs Argument passed to functions f and nextep
+ * @param step Step in days, negative to search backwards
+ * @param nextep Function returning next time to evaluate, or NULL
+ * @param stop Limit search to a certain time, expressed in days, or 0
+ * @param refine Refinement method (SWH_REFINE_*)
+ * @param ret Julian day number found
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 2 if time limit reached
+ */
+int swh_secsearch(
+    double t1,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double step,
+    int (*nextep)(double step, void* args, double* t, char* err),
+    double stop,
+    int refine,
+    double* ret,
+    char* err);
+
+/** @brief Generic search of the first root of two functions
+ *
+ * Same as swh_secsearch, for two functions of angles differing by a
+ * constant: the second is swe_difdeg2n(f + shift, 0). Both are stepped in
+ * one pass, with the same evaluations, until either changes sign. This is
+ * used to search both sides of an aspect at once.
+ *
+ * @see swh_secsearch()
+ *
+ * @param t1 Julian day number, when search is starting
+ * @param f Function searched
+ * @param fargs Argument passed to functions f and nextep
+ * @param shift Difference of the second function to f, in degrees
+ * @param step Step in days, negative to search backwards
+ * @param nextep Function returning next time to evaluate, or NULL
+ * @param stop Limit search to a certain time, expressed in days, or 0
+ * @param refine Refinement method (SWH_REFINE_*)
+ * @param ret Julian day number found
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 2 if time limit reached
+ */
+int swh_secsearch2(
+    double t1,
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double shift,
+    double step,
+    int (*nextep)(double step, void* args, double* t, char* err),
+    double stop,
+    int refine,
+    double* ret,
+    char* err);
+
+/** @brief Refine a root of a function, within a bracket
+ *
+ * This is the SWH_REFINE_NEWTON stage of swh_secsearch, for callers
+ * that found a sign change by other means.
+ *
+ * @see swh_secsearch()
+ *
+ * @param t1 Julian day of one end of the bracket
+ * @param f1 Function value (and derivative, or HUGE_VAL) at t1
+ * @param t2 Julian day of the other end of the bracket
+ * @param f2 Function value (and derivative, or HUGE_VAL) at t2
+ * @param f Function searched
+ * @param fargs Argument passed to function f
+ * @param ret Julian day number found
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_secsearch_refine(
+    double t1,
+    const double f1[2],
+    double t2,
+    const double f2[2],
+    int (*f)(double t, void* args, double* ret, char* err),
+    void* fargs,
+    double* ret,
+    char* err);
+
 /** @brief Find next direction changing of object
  *
  * This function tries to find when and where a planet in direct or
@@ -38,6 +153,10 @@ extern "C"
  * Flag must include SEFLG_SPEED, and SEFLG_NOGDEFL to avoid bad surprises;
  * alternatively use true positions.
  *
+ * @remarks If a station index is loaded and covers the search, the
+ * station is read from it.
+ * @see swh_stations_load()
+ *
  * @param planet Planet number (SE_*, etc)
  * @param jdstart Julian day number, when search is starting
  * @param backw Search before jdstart [1], or after [0] (boolean)
@@ -108,6 +227,92 @@ int swh_next_aspect2(
     double* posret,
     char *err);
 
+/** @brief Find next exact aspects to many fixed points
+ *
+ * Same as swh_next_aspect, for many fixed points at once. The path of the
+ * planet is sampled once (stopping at stations), and each fixed point is
+ * assigned to the step where it is crossed, with fixed points sorted by
+ * longitude. Each crossing is then refined.
+ *
+ * @remarks If stop is set to 0, the search goes on until all fixed points
+ * are found. Otherwise, the function may return 2 when time limit has been
+ * reached, and fixed points not found have their Julian day set to 0.
+ *
+ * @see swh_next_aspect()
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param aspect Aspect, in degrees [0;360[
+ * @param fixedpts Fixed points targeted [0;360[
+ * @param n Number of fixed points
+ * @param jdstart Julian day number, when search is starting
+ * @param backw Search before jdstart [1], or after [0] (boolean)
+ * @param stop Limit search to a certain time, expressed in days
+ * @param flags Calculation flags, see swisseph docs
+ * @param jdrets Julian day numbers found, declared as double[n]
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 2 if time limit reached, 1 on error
+ */
+int swh_next_aspect_batch(
+    int planet,
+    double aspect,
+    const double* fixedpts,
+    int n,
+    double jdstart,
+    int backw,
+    double stop,
+    int flags,
+    double* jdrets,
+    char* err);
+
+struct swh_return
+{
+    int i;              /* Index of natal longitude */
+    double jd;          /* Julian day number of return */
+    double cusps[37];   /* House cusps, if requested */
+    double ascmc[10];   /* Asc-Mc-etc, if requested */
+};
+
+/** @brief Scan returns of a planet to many natal longitudes
+ *
+ * Find all times within a time range when a planet comes back to natal
+ * longitudes (solar, lunar, planetary returns). The path of the planet is
+ * sampled once, as with swh_next_aspect_batch, and each crossing is
+ * refined. All crossings due to retrograde motion are reported.
+ *
+ * If geographic positions are given, the houses of each return chart are
+ * calculated for the position of its natal longitude.
+ *
+ * The callback is called for each return, in chronological order. If it
+ * returns non-zero, the scan stops.
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param natal Natal longitudes [0;360[
+ * @param n Number of natal longitudes
+ * @param lats Geographic latitudes, declared as double[n], or NULL
+ * @param lons Geographic longitudes, declared as double[n], or NULL
+ * @param hsys House system, see swisseph docs
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with arg and each return
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_return_scan(
+    int planet,
+    const double* natal,
+    int n,
+    const double* lats,
+    const double* lons,
+    int hsys,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_return* ret),
+    void* arg,
+    char* err);
+
 /** @brief Find next aspect between two moving objects
  *
  * Get Julian day number and positions when a celestial object makes a
@@ -117,6 +322,9 @@ int swh_next_aspect2(
  * If stop is set to 0, the search is not limited in time.
  * Otherwise, the function may return 2 when time limit has been reached.
  *
+ * @remarks For known objects, the search steps by the time needed to
+ * reach the aspect at their maximum relative speed, instead of half-days.
+ *
  * @param planet Planet number (SE_*, etc)
  * @param aspect Aspect, in degrees [0;360[
  * @param other Other planet number
@@ -172,6 +380,10 @@ int swh_next_aspect_with2(
  *
  * @remarks If star != NULL, the planet is ignored.
  *
+ * @remarks Below 60 degrees of latitude, the contact is predicted from the
+ * diurnal motion of cusps, with few houses calculations. Beyond, cusps are
+ * searched with small steps.
+ *
  * @see For risings, settings, meridian transits, see swe_rise_trans.
  *
  * @param planet Planet number (SE_*, etc)
@@ -231,11 +443,53 @@ int swh_next_aspect_cusp2(
     double* ascmcret,
     char* err);
 
+/** @brief Find all aspects to house cusps within a time range
+ *
+ * Get Julian day numbers when a celestial object makes a longitudinal
+ * aspect to any house cusp. All cusps are checked from the same houses
+ * calculations.
+ *
+ * The callback is called for each aspect found, in chronological order.
+ * If it returns non-zero, the scan stops.
+ *
+ * @remarks If star != NULL, the planet is ignored.
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param star Fixed star
+ * @param aspect Aspect, in degrees [0;360[
+ * @param jdstart Julian day number, when search is starting
+ * @param jdend Julian day number, when search is ending
+ * @param lat Latitude, in degrees (north is positive)
+ * @param lon Longitude, in degrees (east is positive)
+ * @param hsys House system, see swisseph docs
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with each aspect found, and cusp number
+ * @param arg Argument passed to callback function
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_aspect_cusp_scan(
+    int planet,
+    char* star,
+    double aspect,
+    double jdstart,
+    double jdend,
+    double lat,
+    double lon,
+    int hsys,
+    int flags,
+    int (*callback)(void* arg, double jd, int cusp),
+    void* arg,
+    char* err);
+
 /** @brief Get number of years difference between two julian days
  *
  * One exact "astrological" year can be considered as one solar return.
  * Then is it varying with the type of zodiac in use.
  *
+ * @remarks The number of returns is estimated with the mean tropical (or
+ * sidereal) year, so that only the last return is actually searched.
+ *
  * @param jd1 First Julian day
  * @param jd2 Second Julian day
  * @param flags Calculation flags
@@ -249,6 +503,337 @@ int swh_years_diff(double jd1,
     double* years,
     char* err);
 
+struct swh_aspect_hit
+{
+    double jd;      /* Julian day of exact aspect */
+    int planet;     /* Planet number */
+    int other;      /* Other planet number */
+    int iaspect;    /* Index in the aspects given */
+    double aspect;  /* Aspect matched [0;360[, planet + aspect = other */
+};
+
+/** @brief Find all aspects between objects within a time range
+ *
+ * Sample all objects once per step, and check every pair of planet/other
+ * for all aspects given, in [0;180] (so both sides are searched, as with
+ * swh_next_aspect_with2). Each sign change found is then refined.
+ *
+ * Pairs of the same object are ignored, and a pair appearing twice (in
+ * both orders) is searched only once.
+ *
+ * The callback is called for each aspect found, in chronological order.
+ * If it returns non-zero, the scan stops.
+ *
+ * @param planets Planet numbers
+ * @param nplanets Number of planets
+ * @param others Other planet numbers
+ * @param nothers Number of other planets
+ * @param aspects Aspects, in degrees [0;180]
+ * @param naspects Number of aspects
+ * @param jdstart Julian day number, when search is starting
+ * @param jdend Julian day number, when search is ending
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called for each aspect found
+ * @param arg Argument passed to callback function
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_aspect_scan(
+    const int* planets,
+    int nplanets,
+    const int* others,
+    int nothers,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_aspect_hit* hit),
+    void* arg,
+    char* err);
+
+/** @brief Maximum number of exact times kept in an orb interval */
+#define SWH_ORB_MAXEXACT    3
+
+struct swh_aspect_orb
+{
+    double jdin;    /* Julian day of entry in orb */
+    double jdout;   /* Julian day of exit from orb */
+    int nexact;     /* Number of exact aspects within interval */
+    double exact[SWH_ORB_MAXEXACT]; /* Julian days of exact aspects */
+};
+
+/** @brief Find intervals during which an aspect is within orb
+ *
+ * Scan a time range once for an aspect between two moving objects, and
+ * get each interval where the aspect is within orb: time of entry, times
+ * of exact aspect (retrograde motion can give three), and time of exit.
+ *
+ * Orbs are the same as in swh_match_aspect3: the applying orb is used
+ * while objects are getting closer to the exact aspect, the separating
+ * orb while they are moving apart, and the default orb when their relative
+ * speed is null. The interval may then end (or begin) at a station, when
+ * the orb changes.
+ *
+ * The range is sampled (at most every half day, less for fast objects and
+ * small orbs), and each crossing of orbs, of exact aspect or of null
+ * relative speed is refined as with swh_secsearch_refine.
+ *
+ * The callback is called for each interval, in chronological order. If it
+ * returns non-zero, the scan stops. An interval still open at jdstart or
+ * jdend starts or ends there. Only the first SWH_ORB_MAXEXACT exact times
+ * are kept, nexact counts all of them. If all orbs are null, intervals
+ * are reduced to the exact aspects.
+ *
+ * @remarks If star != NULL, the other planet is ignored.
+ *
+ * @see swh_match_aspect3()
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param aspect Aspect, in degrees [0;360[
+ * @param other Other planet number
+ * @param star Fixed star
+ * @param app_orb Orb, when aspect is applying
+ * @param sep_orb Orb, when aspect is separating
+ * @param def_orb Orb, when aspect is stable
+ * @param jdstart Julian day number, when search is starting
+ * @param jdend Julian day number, when search is ending
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called for each interval found
+ * @param arg Argument passed to callback function
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_aspect_orb_scan(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    double app_orb,
+    double sep_orb,
+    double def_orb,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_aspect_orb* orb),
+    void* arg,
+    char* err);
+
+/* Kinds of search targets */
+#define SWH_TARGET_VALUE    0 /* coordinate of planet */
+#define SWH_TARGET_DIFF     1 /* coordinate of planet minus other's */
+#define SWH_TARGET_SUM      2 /* coordinate of planet plus other's */
+
+struct swh_search_target
+{
+    int planet;     /* Planet number */
+    int other;      /* Other planet number, for differences and sums */
+    int kind;       /* Kind of target (SWH_TARGET_*) */
+    int coord;      /* Index of coordinate in positions [0;5] */
+    int equatorial; /* Equatorial (boolean), else ecliptic coordinates */
+    int wrap;       /* Angle wrapped at 360 degrees (boolean) */
+    double value;   /* Value targeted */
+    int flags;      /* Calculation flags, see swisseph docs */
+};
+
+/** @brief Find next time a coordinate reaches a value
+ *
+ * Generic search on any coordinate returned by swe_calc_ut (longitude,
+ * latitude, distance, or their speeds), in ecliptic or equatorial frame,
+ * of a planet alone, or of the difference or sum with another planet.
+ * For example:
+ *  - parallels: difference of declinations (index 1, equatorial) is 0;
+ *  - contraparallels: sum of declinations is 0;
+ *  - out of bounds: declination reaches the obliquity of the ecliptic;
+ *  - nodes: latitude (index 1, ecliptic) is 0;
+ *  - distance extremes: speed in distance (index 5) is 0.
+ *
+ * Angles wrapped at 360 degrees (longitudes, right ascensions) are
+ * compared with swe_difdeg2n. Positions go through the ephemeris cache
+ * and interpolation, when enabled. SEFLG_SPEED is added to the flags when
+ * searching on speeds (index 3 to 5).
+ *
+ * @remarks If stop is set to 0, the search is not limited in time.
+ * Otherwise, the function may return 2 when time limit has been reached.
+ * Without wrap, differences to the value are expected to stay below 90.
+ *
+ * @param tg Target of the search
+ * @param jdstart Julian day number, when search is starting
+ * @param backw Search before jdstart [1], or after [0] (boolean)
+ * @param stop Limit search to a certain time, expressed in days
+ * @param jdret Julian day number found
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 2 if time limit reached, 3 if invalid
+ * target
+ */
+int swh_next_target(
+    const struct swh_search_target* tg,
+    double jdstart,
+    int backw,
+    double stop,
+    double* jdret,
+    char* err);
+
+/** @brief Cursor over successive events
+ *
+ * A cursor holds the arguments of a search, and the state of the last one
+ * (position, known stations), so that successive events are found without
+ * starting over.
+ */
+struct swh_cursor;
+
+/** @brief Create a cursor over stations of a planet
+ *
+ * @see swh_next_retro()
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param jdstart Julian day number, where the cursor starts
+ * @param flags Calculation flags, see swisseph docs
+ * @param err Buffer for errors, declared as char[256]
+ * @return Cursor, to be freed with swh_cursor_free, or NULL on error
+ */
+struct swh_cursor* swh_cursor_new_retro(
+    int planet,
+    double jdstart,
+    int flags,
+    char* err);
+
+/** @brief Create a cursor over aspects to a fixed point
+ *
+ * @see swh_next_aspect(), swh_next_aspect2()
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param aspect Aspect, in degrees [0;360[, or [0;180] if both
+ * @param fixedpt Fixed point targeted [0;360[
+ * @param both Search both sides of aspect (boolean)
+ * @param jdstart Julian day number, where the cursor starts
+ * @param flags Calculation flags, see swisseph docs
+ * @param err Buffer for errors, declared as char[256]
+ * @return Cursor, to be freed with swh_cursor_free, or NULL on error
+ */
+struct swh_cursor* swh_cursor_new_aspect(
+    int planet,
+    double aspect,
+    double fixedpt,
+    int both,
+    double jdstart,
+    int flags,
+    char* err);
+
+/** @brief Create a cursor over aspects between two moving objects
+ *
+ * @remarks The star name, if any, must stay valid until the cursor is
+ * freed.
+ *
+ * @see swh_next_aspect_with(), swh_next_aspect_with2()
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param aspect Aspect, in degrees [0;360[, or [0;180] if both
+ * @param other Other planet number
+ * @param star Fixed star, or NULL
+ * @param both Search both sides of aspect (boolean)
+ * @param jdstart Julian day number, where the cursor starts
+ * @param flags Calculation flags, see swisseph docs
+ * @param err Buffer for errors, declared as char[256]
+ * @return Cursor, to be freed with swh_cursor_free, or NULL on error
+ */
+struct swh_cursor* swh_cursor_new_aspect_with(
+    int planet,
+    double aspect,
+    int other,
+    char* star,
+    int both,
+    double jdstart,
+    int flags,
+    char* err);
+
+/** @brief Find next event of a cursor
+ *
+ * The cursor moves to the event found. The first call searches from the
+ * starting point of the cursor, following calls from the last event.
+ *
+ * @param cur Cursor
+ * @param stop Limit search to a certain time, expressed in days, or 0
+ * @param jdret Julian day number found
+ * @param posret Planet's positions found, or NULL
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error, 2 if time limit reached
+ */
+int swh_cursor_next(
+    struct swh_cursor* cur,
+    double stop,
+    double* jdret,
+    double* posret,
+    char* err);
+
+/** @brief Find previous event of a cursor
+ *
+ * Same as swh_cursor_next, backwards in time.
+ *
+ * @see swh_cursor_next()
+ */
+int swh_cursor_prev(
+    struct swh_cursor* cur,
+    double stop,
+    double* jdret,
+    double* posret,
+    char* err);
+
+/** @brief Free a cursor
+ * @param cur Cursor, or NULL
+ */
+void swh_cursor_free(struct swh_cursor* cur);
+
+/* Growable buffer of events (any struct with a double jd), for scans */
+struct swh_events_key
+{
+    double jd;
+    int i;
+};
+
+struct swh_events
+{
+    size_t size;    /* size of an event */
+    size_t jdoff;   /* offset of jd in an event */
+    int n;          /* number of events */
+    int max;        /* number of events allocated */
+    char* v;        /* events */
+    struct swh_events_key* keys; /* events in chronological order */
+};
+
+#define SWH_EVENTS_INIT(type)   {sizeof(type), offsetof(type, jd), 0, 0, \
+                                 NULL, NULL}
+
+/* new event at end of buffer, or NULL on error */
+void* _swh_events_add(struct swh_events* ev, char* err);
+
+/* sort events in chronological order (stable) */
+void _swh_events_sort(struct swh_events* ev);
+
+/* event at rank k, once sorted */
+void* _swh_events_get(const struct swh_events* ev, int k);
+
+void _swh_events_free(struct swh_events* ev);
+
+/* Walk the paths in longitude of npaths points, from jdstart to jdend by
+ * step. Steps are split at stations (speed changing sign), and segment is
+ * called on each monotonic part, path after path, with longitudes and
+ * speeds at both ends; done is called at the end of each step, if not
+ * NULL. Positions are returned by pos, in ret[0] (longitude) and ret[1]
+ * (speed). Returns 0 when done, 1 on error, 2 if segment or done returned
+ * 2 (stop), and they return 1 on error. */
+int _swh_path_walk(
+    int npaths,
+    double jdstart,
+    double jdend,
+    double step,
+    int (*pos)(void* arg, int i, double t, double* ret, char* err),
+    int (*segment)(void* arg, int i, double t1, const double* p1,
+                   double t2, const double* p2, char* err),
+    int (*done)(void* arg, char* err),
+    void* arg,
+    char* err);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,160 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhstar.h"
+#include "swhstats.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
+
+static TLS int _swh_star_bypass = 0;
+/* positions were interpolated since last asked */
+static TLS int _swh_star_interp = 0;
+
+int swh_star_bypass(int bypass)
+{
+    const int b = _swh_star_bypass;
+    _swh_star_bypass = bypass ? 1 : 0;
+    return b;
+}
+
+int _swh_star_interpolated(void)
+{
+    const int i = _swh_star_interp;
+    _swh_star_interp = 0;
+    return i;
+}
+
+void swh_star_init(struct swh_star* st, const char* star, int flags)
+{
+    assert(st);
+    assert(star);
+
+    memset(st, 0, sizeof(struct swh_star));
+    strncpy(st->name, star, SE_MAX_STNAME*2);
+    st->flags = flags;
+}
+
+/* positions of anchor i, at day jd */
+int _swh_star_anchor(struct swh_star* st, int i, double jd, char* err)
+{
+    int x;
+    SWH_STATS_INC(fixstar);
+    x = swe_fixstar2_ut(st->name, jd, st->flags, st->pos[i], err);
+    if (x < 0)
+        return x;
+    st->iflag = x;
+    return 0;
+}
+
+int swh_star_exact_ut(
+    struct swh_star* st,
+    double tjdut,
+    double* res,
+    char* err)
+{
+    assert(st);
+    assert(res);
+    assert(err);
+
+    SWH_STATS_INC(fixstar);
+    return swe_fixstar2_ut(st->name, tjdut, st->flags, res, err);
+}
+
+int swh_star_calc_ut(
+    struct swh_star* st,
+    double tjdut,
+    double* res,
+    char* err)
+{
+    const double day = floor(tjdut);
+    double f;
+    int i, x;
+
+    assert(st);
+    assert(res);
+    assert(err);
+
+    if (_swh_star_bypass
+        || (st->flags & (SEFLG_TOPOCTR|SEFLG_XYZ|SEFLG_RADIANS)))
+        return swh_star_exact_ut(st, tjdut, res, err);
+    if (!st->valid || day != st->jd) {
+        if (st->valid && day == st->jd + 1) {
+            memcpy(st->pos[0], st->pos[1], sizeof(double) * 6);
+            x = _swh_star_anchor(st, 1, day + 1, err);
+        }
+        else if (st->valid && day == st->jd - 1) {
+            memcpy(st->pos[1], st->pos[0], sizeof(double) * 6);
+            x = _swh_star_anchor(st, 0, day, err);
+        }
+        else if (day != st->miss) {
+            /* anchors are worth it on a second call within that day */
+            st->miss = day;
+            return swh_star_exact_ut(st, tjdut, res, err);
+        }
+        else {
+            x = _swh_star_anchor(st, 0, day, err);
+            if (!x)
+                x = _swh_star_anchor(st, 1, day + 1, err);
+        }
+        if (x) {
+            st->valid = 0;
+            return x;
+        }
+        st->jd = day;
+        st->valid = 1;
+    }
+    _swh_star_interp = 1;
+    f = tjdut - day;
+    res[0] = swe_degnorm(st->pos[0][0]
+                         + (f * swe_difdeg2n(st->pos[1][0], st->pos[0][0])));
+    for (i = 1; i < 6; ++i)
+        res[i] = st->pos[0][i] + (f * (st->pos[1][i] - st->pos[0][i]));
+    return st->iflag;
+}
+
+int swh_star_calc_batch(
+    struct swh_star* stars,
+    int n,
+    double tjdut,
+    double* res,
+    char* err)
+{
+    int i;
+
+    assert(stars);
+    assert(res);
+    assert(err);
+
+    for (i = 0; i < n; ++i) {
+        if (swh_star_calc_ut(&stars[i], tjdut, &res[i*6], err) < 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
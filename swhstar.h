@@ -0,0 +1,136 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHSTAR_H
+#define SWHSTAR_H
+
+#include <swephexp.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Fixed star handle
+ *
+ * A handle keeps the name of a star (as resolved by swisseph on first
+ * use), and its positions at two successive days (anchors). Positions in
+ * between are interpolated, so that the catalog is only searched when a
+ * new day is reached. A position far from the anchors is calculated
+ * exactly, and anchors are set on the next call within the same day.
+ *
+ * Handles need no allocation, and can be declared on the stack.
+ *
+ * @remarks Stars move slowly and smoothly (precession, nutation, annual
+ * aberration). The error of the linear interpolation is dominated by the
+ * 13.66 days term of nutation, and reaches about 0.006" for geocentric
+ * positions. Topocentric positions (SEFLG_TOPOCTR), whose diurnal
+ * aberration has a period of one day, cartesian coordinates and radians
+ * (SEFLG_XYZ, SEFLG_RADIANS) are not interpolated. Use swh_star_exact_ut
+ * where exact positions are required. Searches with a fixed star step
+ * with interpolated positions, and correct the roots found with exact
+ * ones.
+ */
+struct swh_star
+{
+    char name[(SE_MAX_STNAME*2)+1]; /* Star name */
+    int flags;          /* Calculation flags */
+    int iflag;          /* Flags returned by swisseph */
+    int valid;          /* If anchors are calculated */
+    double jd;          /* Julian day of first anchor */
+    double pos[2][6];   /* Positions at anchors */
+    double miss;        /* Day of last position calculated off anchors */
+};
+
+/** @brief Initialize a fixed star handle
+ *
+ * The star is looked up on first calculation.
+ *
+ * @param st Star handle
+ * @param star Star name, as for swe_fixstar2_ut
+ * @param flags Calculation flags, see swisseph docs
+ */
+void swh_star_init(struct swh_star* st, const char* star, int flags);
+
+/** @brief Calculate positions of a fixed star
+ *
+ * @param st Star handle
+ * @param tjdut Julian day number, UT
+ * @param res Positions, declared as double[6]
+ * @param err Buffer for errors, declared as char[256]
+ * @return Flags returned by swisseph, or -1 (ERR) on error
+ */
+int swh_star_calc_ut(
+    struct swh_star* st,
+    double tjdut,
+    double* res,
+    char* err);
+
+/** @brief Calculate exact positions of a fixed star
+ *
+ * Same as swe_fixstar2_ut, without interpolation, but the star is looked
+ * up faster once resolved in the handle.
+ *
+ * @param st Star handle
+ * @param tjdut Julian day number, UT
+ * @param res Positions, declared as double[6]
+ * @param err Buffer for errors, declared as char[256]
+ * @return Flags returned by swisseph, or -1 (ERR) on error
+ */
+int swh_star_exact_ut(
+    struct swh_star* st,
+    double tjdut,
+    double* res,
+    char* err);
+
+/** @brief Temporarily bypass interpolation of fixed stars
+ *
+ * Used to get exact positions from swh_star_calc_ut, for the current
+ * thread.
+ *
+ * @param bypass Bypass [1], or restore [0] interpolation (boolean)
+ * @return Previous bypass value
+ */
+int swh_star_bypass(int bypass);
+
+/* if positions were interpolated since last call, for the current thread */
+int _swh_star_interpolated(void);
+
+/** @brief Calculate positions of many fixed stars
+ *
+ * @param stars Star handles
+ * @param n Number of stars
+ * @param tjdut Julian day number, UT
+ * @param res Positions, declared as double[6*n]
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_star_calc_batch(
+    struct swh_star* stars,
+    int n,
+    double tjdut,
+    double* res,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHSTAR_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,396 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <swephexp.h>
+
+#include "swhsearch.h"
+#include "swhstations.h"
+#include "swhstats.h"
+
+#define MAGIC   "SWHSTAT"
+#define ENDIAN  (0x01020304)
+/* step of the generator, in days */
+#define STEP    (0.5)
+
+/*
+ * File layout (native byte order):
+ *  header
+ *  directory, one entry per planet
+ *  stations of each planet, in ascending order (double)
+ */
+
+typedef struct
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int endian;
+    int flags;
+    int nplanets;
+    double jdstart;
+    double jdend;
+} swh_stations_header_t;
+
+typedef struct
+{
+    int planet;
+    int count;
+    long long offset; /* in bytes, from start of file */
+} swh_stations_dir_t;
+
+static char* _swh_stations_data = NULL;
+static size_t _swh_stations_size = 0;
+static const swh_stations_header_t* _swh_stations_hdr = NULL;
+static const swh_stations_dir_t* _swh_stations_dir = NULL;
+
+int _swh_stations_check(char* err)
+{
+    const swh_stations_header_t* hdr = (void*) _swh_stations_data;
+    const swh_stations_dir_t* dir;
+    int i;
+
+    if (_swh_stations_size < sizeof(swh_stations_header_t)
+        || memcmp(hdr->magic, MAGIC, 8)) {
+        sprintf(err, "invalid stations file");
+        return 1;
+    }
+    if (hdr->endian != ENDIAN || hdr->version != SWH_STATIONS_VERSION) {
+        sprintf(err, "unsupported stations file version");
+        return 1;
+    }
+    if (hdr->nplanets < 0 || _swh_stations_size
+        < sizeof(swh_stations_header_t)
+            + (sizeof(swh_stations_dir_t) * hdr->nplanets)) {
+        sprintf(err, "invalid stations file");
+        return 1;
+    }
+    dir = (void*) (_swh_stations_data + sizeof(swh_stations_header_t));
+    for (i = 0; i < hdr->nplanets; ++i) {
+        if (dir[i].count < 0 || dir[i].offset < 0
+            || dir[i].offset % sizeof(double)
+            || (size_t) dir[i].offset
+                + (sizeof(double) * dir[i].count) > _swh_stations_size) {
+            sprintf(err, "invalid stations file");
+            return 1;
+        }
+    }
+    _swh_stations_hdr = hdr;
+    _swh_stations_dir = dir;
+    return 0;
+}
+
+int swh_stations_load(const char* path, char* err)
+{
+#ifdef _WIN32
+    FILE* f;
+    long sz;
+#else
+    int fd;
+    struct stat st;
+#endif
+
+    assert(err);
+
+    if (!path)
+        path = getenv(SWH_STATIONS_ENV);
+    if (!path || !*path) {
+        sprintf(err, "no stations file");
+        return 1;
+    }
+    swh_stations_unload();
+#ifdef _WIN32
+    f = fopen(path, "rb");
+    if (!f) {
+        sprintf(err, "unable to open stations file");
+        return 1;
+    }
+    if (fseek(f, 0, SEEK_END) || (sz = ftell(f)) < 0
+        || fseek(f, 0, SEEK_SET)) {
+        fclose(f);
+        sprintf(err, "unable to read stations file");
+        return 1;
+    }
+    _swh_stations_data = malloc(sz + 1);
+    if (!_swh_stations_data) {
+        fclose(f);
+        sprintf(err, "nomem");
+        return 1;
+    }
+    _swh_stations_size = sz;
+    if (fread(_swh_stations_data, 1, sz, f) != (size_t) sz) {
+        fclose(f);
+        swh_stations_unload();
+        sprintf(err, "unable to read stations file");
+        return 1;
+    }
+    fclose(f);
+#else
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        sprintf(err, "unable to open stations file");
+        return 1;
+    }
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        sprintf(err, "unable to read stations file");
+        return 1;
+    }
+    _swh_stations_data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED,
+                              fd, 0);
+    close(fd);
+    if (_swh_stations_data == MAP_FAILED) {
+        _swh_stations_data = NULL;
+        sprintf(err, "unable to map stations file");
+        return 1;
+    }
+    _swh_stations_size = st.st_size;
+#endif
+    if (_swh_stations_check(err)) {
+        swh_stations_unload();
+        return 1;
+    }
+    return 0;
+}
+
+void swh_stations_unload(void)
+{
+    if (_swh_stations_data) {
+#ifdef _WIN32
+        free(_swh_stations_data);
+#else
+        munmap(_swh_stations_data, _swh_stations_size);
+#endif
+    }
+    _swh_stations_data = NULL;
+    _swh_stations_size = 0;
+    _swh_stations_hdr = NULL;
+    _swh_stations_dir = NULL;
+}
+
+int swh_stations_loaded(void)
+{
+    return _swh_stations_hdr ? 1 : 0;
+}
+
+int swh_stations_find(
+    int planet,
+    double jdstart,
+    int backw,
+    int flags,
+    double* jdret)
+{
+    const double* t;
+    int i, lo, hi;
+
+    assert(jdret);
+
+    if (!_swh_stations_hdr
+        || (flags & SWH_STATIONS_FLAGMASK)
+            != (_swh_stations_hdr->flags & SWH_STATIONS_FLAGMASK)
+        || jdstart < _swh_stations_hdr->jdstart
+        || jdstart > _swh_stations_hdr->jdend)
+        return 1;
+    for (i = 0; i < _swh_stations_hdr->nplanets; ++i) {
+        if (_swh_stations_dir[i].planet == planet)
+            break;
+    }
+    if (i == _swh_stations_hdr->nplanets)
+        return 1;
+    t = (const double*) (_swh_stations_data + _swh_stations_dir[i].offset);
+    /* first station after jdstart */
+    lo = 0;
+    hi = _swh_stations_dir[i].count;
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) / 2);
+        if (t[mid] <= jdstart)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (backw) {
+        /* last station before jdstart */
+        while (lo > 0 && t[lo - 1] >= jdstart)
+            --lo;
+        if (lo == 0)
+            return 1;
+        *jdret = t[lo - 1];
+    }
+    else {
+        if (lo == _swh_stations_dir[i].count)
+            return 1;
+        *jdret = t[lo];
+    }
+    return 0;
+}
+
+typedef struct
+{
+    int planet;
+    int flags;
+} swh_stations_args_t;
+
+int _swh_stations_speed(double t, void* fargs, double* ret, char* err)
+{
+    const swh_stations_args_t* args = fargs;
+    double res[6] = {0,0,0,0,0,0};
+
+    SWH_STATS_INC(calc);
+    if (swe_calc_ut(t, args->planet, args->flags, res, err) < 0)
+        return 1;
+    ret[0] = res[3];
+    return 0;
+}
+
+int swh_stations_make(
+    const char* path,
+    const int* planets,
+    int nplanets,
+    double jdstart,
+    double jdend,
+    int flags,
+    char* err)
+{
+    FILE* f = NULL;
+    double* t = NULL;
+    swh_stations_header_t hdr;
+    swh_stations_dir_t* dir = NULL;
+    long long offset;
+    int maxt = 0;
+    int i, x = 0;
+
+    assert(path);
+    assert(planets);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    flags |= SEFLG_SPEED;
+    dir = calloc(nplanets + 1, sizeof(swh_stations_dir_t));
+    if (!dir) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    f = fopen(path, "wb");
+    if (!f) {
+        free(dir);
+        sprintf(err, "unable to open stations file");
+        return 1;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, MAGIC, 8);
+    hdr.version = SWH_STATIONS_VERSION;
+    hdr.endian = ENDIAN;
+    hdr.flags = flags;
+    hdr.nplanets = nplanets;
+    hdr.jdstart = jdstart;
+    hdr.jdend = jdend;
+    offset = sizeof(hdr) + (sizeof(swh_stations_dir_t) * nplanets);
+    /* directory is written once stations are known */
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1
+        || fseek(f, (long) offset, SEEK_SET)) {
+        sprintf(err, "unable to write stations file");
+        x = 1;
+        goto end;
+    }
+    for (i = 0; i < nplanets; ++i) {
+        swh_stations_args_t args = {planets[i], flags};
+        double t1 = jdstart, t2;
+        double f1[2] = {0, HUGE_VAL}, f2[2] = {0, HUGE_VAL};
+        int n = 0;
+
+        if (_swh_stations_speed(t1, &args, f1, err)) {
+            x = 1;
+            goto end;
+        }
+        /* one pass through the range, every sign change is a station */
+        while (t1 < jdend) {
+            t2 = t1;
+            f2[0] = f1[0];
+            t1 = t2 + STEP;
+            if (t1 > jdend)
+                t1 = jdend;
+            if (_swh_stations_speed(t1, &args, f1, err)) {
+                x = 1;
+                goto end;
+            }
+            if (f2[0] == 0 || (f1[0] != 0 && (f1[0] < 0) == (f2[0] < 0)))
+                continue;
+            if (n == maxt) {
+                double* p = realloc(t, sizeof(double) * (maxt + 256));
+                if (!p) {
+                    sprintf(err, "nomem");
+                    x = 1;
+                    goto end;
+                }
+                t = p;
+                maxt += 256;
+            }
+            if (f1[0] == 0)
+                t[n] = t1;
+            else if (swh_secsearch_refine(t1, f1, t2, f2,
+                                          &_swh_stations_speed, &args,
+                                          &t[n], err)) {
+                x = 1;
+                goto end;
+            }
+            ++n;
+        }
+        dir[i].planet = planets[i];
+        dir[i].count = n;
+        dir[i].offset = offset;
+        if (n && fwrite(t, sizeof(double), n, f) != (size_t) n) {
+            sprintf(err, "unable to write stations file");
+            x = 1;
+            goto end;
+        }
+        offset += sizeof(double) * n;
+    }
+    if (fseek(f, sizeof(hdr), SEEK_SET)
+        || (nplanets && fwrite(dir, sizeof(swh_stations_dir_t), nplanets, f)
+            != (size_t) nplanets)) {
+        sprintf(err, "unable to write stations file");
+        x = 1;
+    }
+  end:
+    if (fclose(f) && !x) {
+        sprintf(err, "unable to write stations file");
+        x = 1;
+    }
+    if (x)
+        remove(path);
+    free(dir);
+    if (t)
+        free(t);
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
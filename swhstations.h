@@ -0,0 +1,114 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHSTATIONS_H
+#define SWHSTATIONS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Version of the station index file format */
+#define SWH_STATIONS_VERSION    1
+
+/** @brief Calculation flags that must match those of the index
+ *
+ * Flags not in this mask (ephemeris selection, speed) do not change the
+ * stations found beyond the search precision.
+ */
+#define SWH_STATIONS_FLAGMASK   (SEFLG_HELCTR|SEFLG_TRUEPOS|SEFLG_J2000\
+    |SEFLG_NONUT|SEFLG_NOGDEFL|SEFLG_NOABERR|SEFLG_EQUATORIAL\
+    |SEFLG_BARYCTR|SEFLG_TOPOCTR|SEFLG_SIDEREAL)
+
+/** @brief Environment variable giving the path to the station index */
+#define SWH_STATIONS_ENV        "SWH_STATIONS_PATH"
+
+/** @brief Load a station index
+ *
+ * The file is mapped in memory (read in memory on Windows) and shared by
+ * all threads. Once loaded, swh_next_retro answers from the index when
+ * possible.
+ *
+ * @remarks The index only answers searches whose flags match those it
+ * was generated with, in SWH_STATIONS_FLAGMASK. The generator uses
+ * SEFLG_NOGDEFL by default, as recommended for swh_next_retro.
+ *
+ * @remarks Loading and unloading are not thread-safe: do it before
+ * starting, or after stopping, threads that search.
+ *
+ * @param path Path to index file, or NULL to use SWH_STATIONS_PATH
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_stations_load(const char* path, char* err);
+
+/** @brief Unload the station index, if any */
+void swh_stations_unload(void);
+
+/** @brief Check if a station index is loaded
+ * @return 1 if loaded, else 0
+ */
+int swh_stations_loaded(void);
+
+/** @brief Find next station of a planet in the index
+ *
+ * @param planet Planet number (SE_*, etc)
+ * @param jdstart Julian day number, when search is starting
+ * @param backw Search before jdstart [1], or after [0] (boolean)
+ * @param flags Calculation flags, see swisseph docs
+ * @param jdret Julian day number found
+ * @return 0 if found, 1 if the index can not answer
+ */
+int swh_stations_find(
+    int planet,
+    double jdstart,
+    int backw,
+    int flags,
+    double* jdret);
+
+/** @brief Generate a station index file
+ *
+ * Step through the time range for each planet and write all stations
+ * found (both retrograde and direct) to a file.
+ *
+ * @param path Path to index file
+ * @param planets Planet numbers
+ * @param nplanets Number of planets
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_stations_make(
+    const char* path,
+    const int* planets,
+    int nplanets,
+    double jdstart,
+    double jdend,
+    int flags,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHSTATIONS_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,102 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <string.h>
+#ifdef SWH_SEARCH_STATS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+#include "swhstats.h"
+
+#ifdef _MSC_VER
+#define TLS __declspec(thread)
+#else
+#define TLS __thread
+#endif
+
+#ifdef SWH_SEARCH_STATS
+
+static TLS struct swh_search_stats _swh_stats;
+static TLS int _swh_stats_depth = 0;
+static TLS double _swh_stats_start = 0;
+
+/* monotonic clock, in seconds */
+double _swh_search_stats_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER c, f;
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (double) c.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+#endif
+}
+
+struct swh_search_stats* _swh_search_stats(void)
+{
+    return &_swh_stats;
+}
+
+void _swh_search_stats_enter(void)
+{
+    if (_swh_stats_depth++ == 0) {
+        ++_swh_stats.searches;
+        _swh_stats_start = _swh_search_stats_now();
+    }
+    if (_swh_stats_depth > _swh_stats.maxdepth)
+        _swh_stats.maxdepth = _swh_stats_depth;
+}
+
+void _swh_search_stats_leave(void)
+{
+    assert(_swh_stats_depth > 0);
+    if (--_swh_stats_depth == 0)
+        _swh_stats.seconds += _swh_search_stats_now() - _swh_stats_start;
+}
+
+#endif /* SWH_SEARCH_STATS */
+
+int swh_search_stats_get(struct swh_search_stats* st)
+{
+    assert(st);
+#ifdef SWH_SEARCH_STATS
+    memcpy(st, &_swh_stats, sizeof(struct swh_search_stats));
+    return 0;
+#else
+    memset(st, 0, sizeof(struct swh_search_stats));
+    return 1;
+#endif
+}
+
+void swh_search_stats_reset(void)
+{
+#ifdef SWH_SEARCH_STATS
+    memset(&_swh_stats, 0, sizeof(struct swh_search_stats));
+#endif
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,75 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHSTATS_H
+#define SWHSTATS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Statistics of the search functions
+ *
+ * Counters are filled in by the search functions of the current thread,
+ * when swephelp is compiled with SWH_SEARCH_STATS defined. Otherwise they
+ * are not maintained at all.
+ */
+struct swh_search_stats
+{
+    unsigned long long searches;    /* Searches (and scans) started */
+    unsigned long long evals;       /* Target function evaluations */
+    unsigned long long calc;        /* Calls to swe_calc_ut */
+    unsigned long long houses;      /* Calls to swe_houses_ex */
+    unsigned long long fixstar;     /* Calls to swe_fixstar2_ut */
+    unsigned long long cached;      /* Positions or houses from cache */
+    unsigned long long interp;      /* Positions interpolated */
+    int maxdepth;   /* Deepest nesting of searches calling searches */
+    double seconds; /* Wall time spent in searches */
+};
+
+/** @brief Get statistics of the search functions, for the current thread
+ * @param st Statistics returned
+ * @return 0 on success, 1 if statistics are not compiled in (zeroed)
+ */
+int swh_search_stats_get(struct swh_search_stats* st);
+
+/** @brief Reset statistics of the search functions, for the current thread
+ */
+void swh_search_stats_reset(void);
+
+#ifdef SWH_SEARCH_STATS
+struct swh_search_stats* _swh_search_stats(void);
+void _swh_search_stats_enter(void);
+void _swh_search_stats_leave(void);
+#define SWH_STATS_INC(field)    (++_swh_search_stats()->field)
+#define SWH_STATS_ENTER()       _swh_search_stats_enter()
+#define SWH_STATS_LEAVE()       _swh_search_stats_leave()
+#else
+#define SWH_STATS_INC(field)
+#define SWH_STATS_ENTER()
+#define SWH_STATS_LEAVE()
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHSTATS_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
@@ -0,0 +1,226 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swephexp.h>
+
+#include "swhcache.h"
+#include "swhcontext.h"
+#include "swhsearch.h"
+#include "swhstats.h"
+#include "swhvoc.h"
+
+/* step, in days: the Moon can not cross a sign, or two aspects to one
+ * planet, within a step */
+#define STEP    (1.0)
+/* longest stay of the Moon in a sign, in days */
+#define MAXSIGN (3.0)
+
+typedef struct
+{
+    int planet;     /* planet, or -1 for ingress */
+    int flags;
+    double lon;     /* aspect, or sign boundary */
+} swh_voc_args_t;
+
+/* elongation of the Moon from planet (or longitude) to target */
+int _swh_voc(double t, void* fargs, double* ret, char* err)
+{
+    const swh_voc_args_t* args = fargs;
+    double moon[6] = {0,0,0,0,0,0};
+    double res[6] = {0,0,0,0,0,0};
+
+    int x = swh_cache_calc_ut(t, SE_MOON, args->flags, moon, err);
+    if (x < 0)
+        return x;
+    if (args->planet >= 0) {
+        x = swh_cache_calc_ut(t, args->planet, args->flags, res, err);
+        if (x < 0)
+            return x;
+    }
+    ret[0] = swe_difdeg2n(moon[0] - res[0], args->lon);
+    ret[1] = moon[3] - res[3];
+    return 0;
+}
+
+int swh_voc_scan(
+    const int* planets,
+    int nplanets,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_voc* voc),
+    void* arg,
+    char* err)
+{
+    const double majors[] = {0, 60, 90, 120, 180};
+    double* pos = NULL; /* positions at both ends of step, Moon first */
+    double *p1, *p2;
+    struct swh_voc cur, before, after;
+    double t1, t2 = jdstart - MAXSIGN;
+    unsigned int istep = 0;
+    int i, j, k, x = 0;
+
+    assert(planets);
+    assert(callback);
+    assert(err);
+
+    if (jdstart >= jdend) {
+        sprintf(err, "invalid time range");
+        return 1;
+    }
+    if (!aspects) {
+        aspects = majors;
+        naspects = sizeof(majors) / sizeof(double);
+    }
+    pos = malloc(sizeof(double) * 12 * (nplanets + 1));
+    if (!pos) {
+        sprintf(err, "nomem");
+        return 1;
+    }
+    p1 = pos;
+    p2 = pos + (6 * (nplanets + 1));
+    flags |= SEFLG_SPEED;
+    SWH_STATS_ENTER();
+    /* no aspect known before the first ingress found */
+    memset(&cur, 0, sizeof(cur));
+    cur.planet = -1;
+    for (i = -1; i < nplanets; ++i) {
+        if (swh_cache_calc_ut(t2, i < 0 ? SE_MOON : planets[i], flags,
+                              &p2[6 * (i + 1)], err) < 0) {
+            x = 1;
+            goto end;
+        }
+    }
+    while (t2 < jdend) {
+        double* p = p1;
+        double ti = 0; /* ingress in step, if any */
+        if (_swh_search_ctx_check(t2, err)) {
+            x = 1;
+            goto end;
+        }
+        p1 = p2;
+        p2 = p;
+        t1 = t2;
+        t2 = jdstart - MAXSIGN + (++istep * STEP);
+        if (t2 > jdend)
+            t2 = jdend;
+        for (i = -1; i < nplanets; ++i) {
+            if (swh_cache_calc_ut(t2, i < 0 ? SE_MOON : planets[i], flags,
+                                  &p2[6 * (i + 1)], err) < 0) {
+                x = 1;
+                goto end;
+            }
+        }
+        /* ingress */
+        if ((int) (p1[0] / 30) != (int) (p2[0] / 30)) {
+            swh_voc_args_t args = {-1, flags, 30 * (int) (p2[0] / 30)};
+            double f1[2] = {0, 0}, f2[2] = {0, 0};
+            f1[0] = swe_difdeg2n(p1[0], args.lon);
+            f1[1] = p1[3];
+            f2[0] = swe_difdeg2n(p2[0], args.lon);
+            f2[1] = p2[3];
+            if (f2[0] == 0)
+                ti = t2;
+            else if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_voc, &args,
+                                          &ti, err)) {
+                x = 1;
+                goto end;
+            }
+        }
+        /* last aspects of step, before and after ingress */
+        memset(&before, 0, sizeof(before));
+        memset(&after, 0, sizeof(after));
+        for (i = 0; i < nplanets; ++i) {
+            const double* q1 = &p1[6 * (i + 1)];
+            const double* q2 = &p2[6 * (i + 1)];
+            const double e1 = p1[0] - q1[0];
+            const double e2 = p2[0] - q2[0];
+            if (planets[i] == SE_MOON)
+                continue;
+            for (j = 0; j < naspects; ++j) {
+                const double asp = swe_degnorm(aspects[j]);
+                for (k = 0; k < (asp == 0 || asp == 180 ? 1 : 2); ++k) {
+                    swh_voc_args_t args = {planets[i], flags,
+                                           k ? -asp : asp};
+                    double f1[2] = {0, 0}, f2[2] = {0, 0};
+                    double ta;
+                    f1[0] = swe_difdeg2n(e1, args.lon);
+                    f1[1] = p1[3] - q1[3];
+                    f2[0] = swe_difdeg2n(e2, args.lon);
+                    f2[1] = p2[3] - q2[3];
+                    if (fabs(f1[0]) > 90 || f1[0] == 0
+                        || (f2[0] != 0 && (f1[0] < 0) == (f2[0] < 0)))
+                        continue;
+                    if (f2[0] == 0)
+                        ta = t2;
+                    else if (swh_secsearch_refine(t2, f2, t1, f1, &_swh_voc,
+                                                  &args, &ta, err)) {
+                        x = 1;
+                        goto end;
+                    }
+                    if (ti && ta < ti) {
+                        if (ta <= before.jdstart)
+                            continue;
+                        before.jdstart = ta;
+                        before.planet = planets[i];
+                        before.aspect = asp;
+                    }
+                    else if (ta > after.jdstart) {
+                        after.jdstart = ta;
+                        after.planet = planets[i];
+                        after.aspect = asp;
+                    }
+                }
+            }
+        }
+        if (ti) {
+            if (before.jdstart > cur.jdstart) {
+                cur.jdstart = before.jdstart;
+                cur.planet = before.planet;
+                cur.aspect = before.aspect;
+            }
+            cur.jdend = ti;
+            cur.sign = (int) (p1[0] / 30);
+            /* periods known from a previous ingress only */
+            if (ti > jdstart && cur.jdstart && callback(arg, &cur))
+                goto end;
+            cur.jdstart = ti;
+            cur.planet = -1;
+            cur.aspect = 0;
+        }
+        if (after.jdstart > cur.jdstart) {
+            cur.jdstart = after.jdstart;
+            cur.planet = after.planet;
+            cur.aspect = after.aspect;
+        }
+    }
+  end:
+    SWH_STATS_LEAVE();
+    free(pos);
+    return x;
+}
+
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */
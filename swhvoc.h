@@ -0,0 +1,82 @@
+/*
+    Swephelp
+
+    Copyright 2007-2020 Stanislas Marquis <stan@astrorigin.com>
+
+    Swephelp is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of
+    the License, or (at your option) any later version.
+
+    Swephelp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Swephelp.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWHVOC_H
+#define SWHVOC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct swh_voc
+{
+    double jdstart; /* Last aspect in sign, or previous ingress if none */
+    double jdend;   /* Ingress of the Moon in next sign */
+    int planet;     /* Planet of last aspect, or -1 if none */
+    double aspect;  /* Last aspect, in degrees */
+    int sign;       /* Sign left [0;11] */
+};
+
+/** @brief Scan void-of-course periods of the Moon
+ *
+ * The Moon is void of course from its last aspect to the given planets
+ * in a sign, until it enters the next sign. If it makes no aspect in a
+ * sign, the whole sign is void, and planet is -1.
+ *
+ * The Moon is followed once through the time range, and aspects to all
+ * planets are found from the same samples (planet positions go through
+ * the ephemeris cache and interpolation, when enabled). Aspects are
+ * matched both ways, as with swh_next_aspect_with.
+ *
+ * The callback is called with each period ending within the time range,
+ * in chronological order. A period may start before jdstart. If the
+ * callback returns non-zero, the scan stops.
+ *
+ * @param planets Planet numbers
+ * @param nplanets Number of planets
+ * @param aspects Aspects, in degrees, or NULL for major aspects
+ * (0, 60, 90, 120, 180)
+ * @param naspects Number of aspects
+ * @param jdstart Julian day number, start of range
+ * @param jdend Julian day number, end of range
+ * @param flags Calculation flags, see swisseph docs
+ * @param callback Function called with arg and each period
+ * @param arg Argument passed to callback
+ * @param err Buffer for errors, declared as char[256]
+ * @return 0 on success, 1 on error
+ */
+int swh_voc_scan(
+    const int* planets,
+    int nplanets,
+    const double* aspects,
+    int naspects,
+    double jdstart,
+    double jdend,
+    int flags,
+    int (*callback)(void* arg, const struct swh_voc* voc),
+    void* arg,
+    char* err);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SWHVOC_H */
+/* vi: set fenc=utf-8 ff=unix et sw=4 ts=4 : */